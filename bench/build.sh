@@ -0,0 +1,20 @@
+#!/bin/sh
+# Builds the benchmark harness on Linux. Pass -d for a debug build.
+
+exeName="bench"
+compilerFlags="-std=c++20 -Wall -Wextra -Werror -Wno-unused-parameter -Wno-unused-variable -Wno-ignored-qualifiers -fno-rtti -pthread"
+
+if [ "$1" = "-d" ]; then
+    compilerFlags="$compilerFlags -O0 -g"
+else
+    compilerFlags="$compilerFlags -O2"
+fi
+
+rm -f "$exeName"
+
+if ${CXX:-g++} $compilerFlags src/bench.cpp -o "$exeName"; then
+    echo "Build successful"
+else
+    echo "Build failed"
+    exit 1
+fi
\ No newline at end of file
@@ -0,0 +1,80 @@
+#include "../../src/batch.h"
+#include "../../src/instructions.h"
+#include "../../src/nes.h"
+#include "perf_counters.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Touches one byte in each of eight pages per loop so that every instance keeps a working set of private pages hot
+static constexpr u8 page_walk_program[] = {
+    INC_ABS, 0x00, 0x02, INC_ABS, 0x00, 0x03, INC_ABS, 0x00, 0x04, INC_ABS, 0x00, 0x05,
+    INC_ABS, 0x00, 0x06, INC_ABS, 0x00, 0x07, LDA_ABS, 0x00, 0x02, STA_ZP, 0x10, JMP_ABS, 0x00, 0x80,
+};
+
+// The page walk as an NROM image, so that every worker loads its own instances after pinning and first touches their pages itself
+static u8 page_walk_rom[NES::INES_HEADER + NES::PRG_BANK_SIZE] = {'N', 'E', 'S', 0x1A, 1};
+
+static void bench_placement(const Placement placement, const char* name, const size_t instance_count, const size_t thread_count,
+                            const size_t step_count) {
+    BatchRunner batch;
+    batch.init(instance_count, thread_count, placement);
+    if(!batch.load_rom(page_walk_rom, sizeof(page_walk_rom))) {
+        printf("%-8s failed to load the benchmark ROM\n", name);
+        return;
+    }
+
+    u8* actions = new u8[instance_count]();
+    for(size_t i = 0; i < step_count; i++) {
+        batch.step(actions);
+    }
+    delete[] actions;
+
+    printf("%-8s %10.0f instance frames/s, %llu steals\n", name, batch.steps_per_second(), (unsigned long long)batch.scheduler.total_steals());
+    if(placement == Placement::SCATTER) {
+        batch.scheduler.debug_print();
+    }
+}
+
+// One instance on the calling thread, so the host counters measure the interpreter alone rather than the scheduler
+static void bench_dispatch(const size_t instruction_count) {
+    NES* nes = new NES();
+    nes->power_on();
+    nes->ram.load_block(0x8000, page_walk_program, sizeof(page_walk_program));
+    nes->cpu.pc = 0x8000;
+    nes->cpu.execute_instructions(nes->ram, instruction_count / 100); // Warm up the tables and pages before counting
+
+    PerfCounters counters;
+    counters.open();
+    counters.start();
+    const auto begin = std::chrono::steady_clock::now();
+    nes->cpu.execute_instructions(nes->ram, instruction_count);
+    const auto end = std::chrono::steady_clock::now();
+    counters.stop();
+
+    const double seconds = std::chrono::duration<double>(end - begin).count();
+    printf("Dispatch: %zu guest instructions, %.2f ns each, %.1f M/s\n", instruction_count,
+           seconds * 1e9 / static_cast<double>(instruction_count), static_cast<double>(instruction_count) / seconds / 1e6);
+    counters.report(instruction_count);
+    delete nes;
+}
+
+int main(int argc, char** argv) {
+    const size_t thread_count   = argc > 1 ? strtoul(argv[1], nullptr, 10) : 0;
+    const size_t instance_count = argc > 2 ? strtoul(argv[2], nullptr, 10) : 1024;
+    const size_t step_count     = argc > 3 ? strtoul(argv[3], nullptr, 10) : 20;
+    const size_t dispatch_count = argc > 4 ? strtoul(argv[4], nullptr, 10) : 50000000;
+
+    memcpy(&page_walk_rom[NES::INES_HEADER], page_walk_program, sizeof(page_walk_program));
+    page_walk_rom[NES::INES_HEADER + (NES::RESET_VECTOR & 0x3FFF) + 1] = 0x80;
+
+    bench_dispatch(dispatch_count);
+
+    printf("Placement: %zu instances, %zu steps\n", instance_count, step_count);
+    bench_placement(Placement::NONE, "none", instance_count, thread_count, step_count);
+    bench_placement(Placement::COMPACT, "compact", instance_count, thread_count, step_count);
+    bench_placement(Placement::SCATTER, "scatter", instance_count, thread_count, step_count);
+
+    return 0;
+}
\ No newline at end of file
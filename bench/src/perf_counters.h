@@ -0,0 +1,153 @@
+#pragma once
+#include "../../src/types.h"
+#include <stdio.h>
+#include <string.h>
+
+#if defined(__linux__)
+    #include <linux/perf_event.h>
+    #include <sys/ioctl.h>
+    #include <sys/syscall.h>
+    #include <unistd.h>
+#endif
+
+// Host hardware counters around a benchmark run, read with perf_event_open on the calling thread only. Each counter is opened on its
+// own, so a PMU that lacks one event still reports the others. Counters that cannot be opened at all (other platforms, containers,
+// kernel.perf_event_paranoid above 2, virtual machines without a PMU) are reported as unavailable and the benchmark carries on with
+// wall-clock time alone. Counts are scaled when the kernel had to multiplex counters.
+struct PerfCounters {
+    enum Counter : u8 {
+        CYCLES,
+        INSTRUCTIONS,
+        BRANCH_MISSES,
+        L1D_MISSES,
+        COUNTER_COUNT,
+    };
+
+    static constexpr const char* names[COUNTER_COUNT] = {"cycles", "instructions", "branch-misses", "L1d-misses"};
+
+    int descriptors[COUNTER_COUNT] = {-1, -1, -1, -1};
+    u64 values[COUNTER_COUNT]      = {};
+
+    PerfCounters() = default;
+    PerfCounters(const PerfCounters&)            = delete;
+    PerfCounters& operator=(const PerfCounters&) = delete;
+    ~PerfCounters();
+
+    // Returns false when no counter could be opened
+    bool open();
+    void close();
+    void start();
+    void stop();
+
+    [[nodiscard]] bool available(const Counter counter) const;
+    [[nodiscard]] bool any_available() const;
+
+    // Prints every available counter divided by the number of guest instructions run
+    void report(const u64 guest_instructions) const;
+};
+
+PerfCounters::~PerfCounters() {
+    close();
+}
+
+bool PerfCounters::open() {
+    close();
+
+#if defined(__linux__)
+    static constexpr u32 types[COUNTER_COUNT] = {PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HARDWARE, PERF_TYPE_HW_CACHE};
+    static constexpr u64 configs[COUNTER_COUNT] = {
+        PERF_COUNT_HW_CPU_CYCLES,
+        PERF_COUNT_HW_INSTRUCTIONS,
+        PERF_COUNT_HW_BRANCH_MISSES,
+        PERF_COUNT_HW_CACHE_L1D | (PERF_COUNT_HW_CACHE_OP_READ << 8) | (PERF_COUNT_HW_CACHE_RESULT_MISS << 16),
+    };
+
+    for(size_t i = 0; i < COUNTER_COUNT; i++) {
+        perf_event_attr attributes = {};
+        attributes.size            = sizeof(attributes);
+        attributes.type            = types[i];
+        attributes.config          = configs[i];
+        attributes.disabled        = 1;
+        attributes.exclude_kernel  = 1; // Allowed up to perf_event_paranoid 2, and the emulator never enters the kernel anyway
+        attributes.exclude_hv      = 1;
+        attributes.read_format     = PERF_FORMAT_TOTAL_TIME_ENABLED | PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+        descriptors[i] = static_cast<int>(syscall(SYS_perf_event_open, &attributes, 0, -1, -1, 0));
+    }
+#endif
+
+    return any_available();
+}
+
+void PerfCounters::close() {
+#if defined(__linux__)
+    for(int& descriptor : descriptors) {
+        if(descriptor >= 0) {
+            ::close(descriptor);
+        }
+        descriptor = -1;
+    }
+#endif
+}
+
+void PerfCounters::start() {
+    memset(values, 0, sizeof(values));
+
+#if defined(__linux__)
+    for(const int descriptor : descriptors) {
+        if(descriptor >= 0) {
+            ioctl(descriptor, PERF_EVENT_IOC_RESET, 0);
+            ioctl(descriptor, PERF_EVENT_IOC_ENABLE, 0);
+        }
+    }
+#endif
+}
+
+void PerfCounters::stop() {
+#if defined(__linux__)
+    for(size_t i = 0; i < COUNTER_COUNT; i++) {
+        if(descriptors[i] < 0) continue;
+
+        ioctl(descriptors[i], PERF_EVENT_IOC_DISABLE, 0);
+
+        u64 reading[3] = {}; // Value, time enabled, time running
+        if(read(descriptors[i], reading, sizeof(reading)) != static_cast<ssize_t>(sizeof(reading))) {
+            continue;
+        }
+
+        const double scale = reading[2] ? static_cast<double>(reading[1]) / static_cast<double>(reading[2]) : 0.0;
+        values[i]          = static_cast<u64>(static_cast<double>(reading[0]) * scale);
+    }
+#endif
+}
+
+bool PerfCounters::available(const Counter counter) const {
+    return descriptors[counter] >= 0;
+}
+
+bool PerfCounters::any_available() const {
+    for(const int descriptor : descriptors) {
+        if(descriptor >= 0) return true;
+    }
+    return false;
+}
+
+void PerfCounters::report(const u64 guest_instructions) const {
+    if(!any_available()) {
+        printf("  hardware counters unavailable\n");
+        return;
+    }
+
+    const double count = guest_instructions ? static_cast<double>(guest_instructions) : 1.0;
+    for(size_t i = 0; i < COUNTER_COUNT; i++) {
+        if(available(static_cast<Counter>(i))) {
+            printf("  %-14s %10.3f per guest instruction\n", names[i], static_cast<double>(values[i]) / count);
+        } else {
+            printf("  %-14s %10s\n", names[i], "unavailable");
+        }
+    }
+
+    if(available(CYCLES) && available(INSTRUCTIONS) && values[CYCLES]) {
+        printf("  %-14s %10.3f host instructions per cycle\n", "IPC", static_cast<double>(values[INSTRUCTIONS]) / static_cast<double>(values[CYCLES]));
+    }
+}
\ No newline at end of file
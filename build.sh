@@ -0,0 +1,21 @@
+#!/bin/sh
+# Builds the embeddable C API as a Linux shared library. Pass -d for a debug build.
+
+libName="libnes.so"
+compilerFlags="-std=c++20 -Wall -Wextra -Werror -Wno-unused-parameter -Wno-unused-variable -Wno-ignored-qualifiers -fno-rtti -fPIC -fvisibility=hidden -pthread"
+linkerFlags="-shared -Wl,-soname,$libName"
+
+if [ "$1" = "-d" ]; then
+    compilerFlags="$compilerFlags -O0 -g"
+else
+    compilerFlags="$compilerFlags -O2"
+fi
+
+rm -f "$libName"
+
+if ${CXX:-g++} $compilerFlags src/nes_api.cpp -o "$libName" $linkerFlags; then
+    echo "Build successful"
+else
+    echo "Build failed"
+    exit 1
+fi
\ No newline at end of file
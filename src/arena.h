@@ -0,0 +1,128 @@
+#pragma once
+#include "cpu.h"
+#include "instructions.h"
+#include "ram.h"
+#include "types.h"
+#include <new>
+#include <stdlib.h>
+
+// A CPU and its address space, the pair the test and fuzzing harnesses create and throw away by the thousand
+struct alignas(64) Machine {
+    CPU cpu;
+    RAM ram;
+
+    void power_on();
+};
+
+void Machine::power_on() {
+    load_instructions(cpu);
+    cpu.reset();
+    cpu.debug = false;
+    cpu.detach_observers();
+    ram.release();
+    ram.attach_trace(nullptr);
+    ram.clear_watchpoints();
+}
+
+// Hands out instances from slabs of cache line aligned slots. Every slot is constructed and powered on when its slab is created, and
+// is powered on again when it is released, so acquiring an instance is a pop from the free list. Instance needs a power_on() that puts
+// it back in its initial state; for Machine and NES that is a register reset, detaching every observer and watchpoint, plus returning
+// every page to the page pool. Instances that are still acquired when the arena is destroyed are destroyed with it.
+template <typename Instance>
+struct InstanceArena {
+    static constexpr size_t SLAB_INSTANCES = 64;
+    static constexpr size_t SLOT_ALIGN     = alignof(Instance) > 64 ? alignof(Instance) : 64;
+    static constexpr size_t SLOT_SIZE      = (sizeof(Instance) + SLOT_ALIGN - 1) & ~(SLOT_ALIGN - 1);
+
+    InstanceArena() = default;
+    InstanceArena(const InstanceArena&)            = delete;
+    InstanceArena& operator=(const InstanceArena&) = delete;
+    ~InstanceArena();
+
+    [[nodiscard]] Instance* acquire();
+    void release(Instance* instance);
+    void reserve(const size_t instance_count);
+    [[nodiscard]] size_t capacity() const;
+    [[nodiscard]] size_t available() const;
+
+private:
+    u8** slabs            = nullptr;
+    size_t slab_count     = 0;
+    Instance** free_slots = nullptr;
+    size_t free_count     = 0;
+
+    void grow();
+};
+
+template <typename Instance>
+InstanceArena<Instance>::~InstanceArena() {
+    for(size_t i = 0; i < slab_count; i++) {
+        for(size_t j = 0; j < SLAB_INSTANCES; j++) {
+            reinterpret_cast<Instance*>(slabs[i] + j * SLOT_SIZE)->~Instance();
+        }
+        ::operator delete(slabs[i], std::align_val_t{SLOT_ALIGN});
+    }
+
+    free(slabs);
+    free(free_slots);
+}
+
+template <typename Instance>
+Instance* InstanceArena<Instance>::acquire() {
+    if(free_count == 0) {
+        grow();
+    }
+
+    return free_slots[--free_count];
+}
+
+template <typename Instance>
+void InstanceArena<Instance>::release(Instance* instance) {
+    instance->power_on();
+    free_slots[free_count++] = instance;
+}
+
+template <typename Instance>
+void InstanceArena<Instance>::reserve(const size_t instance_count) {
+    while(available() < instance_count) {
+        grow();
+    }
+}
+
+template <typename Instance>
+size_t InstanceArena<Instance>::capacity() const {
+    return slab_count * SLAB_INSTANCES;
+}
+
+template <typename Instance>
+size_t InstanceArena<Instance>::available() const {
+    return free_count;
+}
+
+template <typename Instance>
+void InstanceArena<Instance>::grow() {
+    u8* slab = static_cast<u8*>(::operator new(SLAB_INSTANCES * SLOT_SIZE, std::align_val_t{SLOT_ALIGN}));
+
+    // The free list is sized for every slot so that release never allocates
+    u8** grown_slabs = static_cast<u8**>(realloc(slabs, (slab_count + 1) * sizeof(u8*)));
+    if(grown_slabs) {
+        slabs = grown_slabs;
+    }
+    Instance** grown_free_slots = static_cast<Instance**>(realloc(free_slots, (slab_count + 1) * SLAB_INSTANCES * sizeof(Instance*)));
+    if(grown_free_slots) {
+        free_slots = grown_free_slots;
+    }
+    if(!grown_slabs || !grown_free_slots) {
+        ::operator delete(slab, std::align_val_t{SLOT_ALIGN});
+        throw std::bad_alloc();
+    }
+
+    slabs[slab_count++] = slab;
+
+    // Pushed in reverse so that consecutive acquires walk the slab forwards
+    for(size_t i = SLAB_INSTANCES; i > 0; i--) {
+        Instance* instance = new(slab + (i - 1) * SLOT_SIZE) Instance();
+        instance->power_on();
+        free_slots[free_count++] = instance;
+    }
+}
\ No newline at end of file
@@ -0,0 +1,200 @@
+#pragma once
+#include "arena.h"
+#include "nes.h"
+#include "scheduler.h"
+#include "stats_page.h"
+#include "types.h"
+#include <atomic>
+#include <chrono>
+#include <new>
+
+// Steps a fixed set of instances one frame at a time, in lockstep, on a work-stealing Scheduler. Each step applies one controller
+// action per instance and writes every instance's observation (a window of its address space, by default the 2 KB of work RAM)
+// straight into its row of a single contiguous buffer. The buffer is allocated at init or supplied by the caller, for example the
+// storage behind a tensor, and is never copied. Each worker allocates its home instances from its own InstanceArena, and loads their
+// ROMs, so that under a Placement the instance and its pages are first touched on that worker's NUMA node.
+//
+// There is no PPU yet, so framebuffer observations are not available.
+struct BatchRunner {
+    static constexpr u16 WORK_RAM         = 0x0000;
+    static constexpr size_t WORK_RAM_SIZE = KB(2);
+
+    NES** instances               = nullptr;
+    size_t instance_count         = 0;
+    u8* observations              = nullptr; // instance_count rows of observation_size bytes
+    u16 observation_address       = WORK_RAM;
+    size_t observation_size       = WORK_RAM_SIZE;
+    u64 steps                     = 0; // Instance frames run, summed over every step
+    std::chrono::nanoseconds busy = {};
+    StatsPage* stats              = nullptr; // Published after every step and run when attached
+    Scheduler scheduler;
+
+    BatchRunner() = default;
+    BatchRunner(const BatchRunner&)            = delete;
+    BatchRunner& operator=(const BatchRunner&) = delete;
+    ~BatchRunner();
+
+    // A thread_count of 0 uses one thread per hardware thread. The calling thread always takes a share of the work.
+    void init(const size_t count, const size_t thread_count = 0, const Placement placement = Placement::NONE, const u16 address = WORK_RAM,
+              const size_t size = WORK_RAM_SIZE);
+    void shutdown();
+
+    // Observations go to buffer instead of the internal allocation; it must hold instance_count * observation_size bytes
+    void bind_observations(u8* buffer);
+    [[nodiscard]] bool load_rom(const u8* data, const size_t size);
+
+    // actions[i] is the controller 1 button state for instance i during this frame
+    void step(const u8* actions);
+    // Runs every instance for budget cycles in slices of at most slice cycles, so that slow instances can be spread across workers. A
+    // slice of 0 runs each instance's whole budget as one slice.
+    void run_cycles(const u64 budget, const u64 slice);
+    [[nodiscard]] const u8* observation(const size_t index) const;
+    [[nodiscard]] double steps_per_second() const;
+
+private:
+    InstanceArena<NES>* arenas = nullptr; // One per worker
+    u8* owned_observations     = nullptr;
+    u64* targets               = nullptr;
+    const u8* pending          = nullptr;
+    u64 slice_cycles           = 0;
+    const u8* rom              = nullptr;
+    size_t rom_size            = 0;
+    std::atomic<size_t> rom_failures;
+
+    void publish_stats();
+
+    static bool place_instance(void* context, const size_t item, const size_t worker);
+    static bool load_instance(void* context, const size_t item, const size_t worker);
+    static bool step_instance(void* context, const size_t item, const size_t worker);
+    static bool slice_instance(void* context, const size_t item, const size_t worker);
+};
+
+BatchRunner::~BatchRunner() {
+    shutdown();
+}
+
+void BatchRunner::init(const size_t count, const size_t thread_count, const Placement placement, const u16 address, const size_t size) {
+    shutdown();
+
+    instance_count      = count;
+    observation_address = address;
+    observation_size    = size;
+
+    scheduler.init(thread_count, count, placement);
+    arenas    = new InstanceArena<NES>[scheduler.worker_count];
+    instances = new NES*[count];
+    scheduler.run(count, place_instance, this, false);
+
+    owned_observations = new(std::align_val_t{64}) u8[count * size];
+    observations       = owned_observations;
+    targets            = new u64[count];
+}
+
+void BatchRunner::shutdown() {
+    scheduler.shutdown();
+
+    delete[] arenas;
+    delete[] instances;
+    delete[] targets;
+    arenas         = nullptr;
+    instances      = nullptr;
+    targets        = nullptr;
+    instance_count = 0;
+
+    ::operator delete[](owned_observations, std::align_val_t{64});
+    owned_observations = nullptr;
+    observations       = nullptr;
+    steps              = 0;
+    busy               = {};
+}
+
+void BatchRunner::bind_observations(u8* buffer) {
+    observations = buffer ? buffer : owned_observations;
+}
+
+bool BatchRunner::load_rom(const u8* data, const size_t size) {
+    rom      = data;
+    rom_size = size;
+    rom_failures.store(0, std::memory_order_relaxed);
+    scheduler.run(instance_count, load_instance, this, false);
+
+    return rom_failures.load(std::memory_order_relaxed) == 0;
+}
+
+void BatchRunner::step(const u8* actions) {
+    const auto begin = std::chrono::steady_clock::now();
+
+    pending = actions;
+    scheduler.run(instance_count, step_instance, this);
+
+    steps += instance_count;
+    busy += std::chrono::steady_clock::now() - begin;
+    publish_stats();
+}
+
+void BatchRunner::run_cycles(const u64 budget, const u64 slice) {
+    for(size_t i = 0; i < instance_count; i++) {
+        targets[i] = instances[i]->cpu.cycles + budget;
+    }
+
+    slice_cycles = slice ? slice : budget;
+    scheduler.run(instance_count, slice_instance, this);
+    publish_stats();
+}
+
+void BatchRunner::publish_stats() {
+    if(!stats) return;
+
+    StatsPage::Instance* rows = stats->begin_update(static_cast<u32>(instance_count));
+    const u32 count           = stats->header->totals.instance_count;
+    for(u32 i = 0; i < count; i++) {
+        const NES& nes = *instances[i];
+        rows[i]        = {nes.cpu.cycles, nes.instructions, nes.frame()};
+    }
+    stats->end_update();
+}
+
+const u8* BatchRunner::observation(const size_t index) const {
+    return &observations[index * observation_size];
+}
+
+double BatchRunner::steps_per_second() const {
+    return busy.count() ? steps * 1e9 / busy.count() : 0.0;
+}
+
+bool BatchRunner::place_instance(void* context, const size_t item, const size_t worker) {
+    BatchRunner& batch    = *static_cast<BatchRunner*>(context);
+    batch.instances[item] = batch.arenas[worker].acquire();
+
+    return false;
+}
+
+bool BatchRunner::load_instance(void* context, const size_t item, const size_t worker) {
+    BatchRunner& batch = *static_cast<BatchRunner*>(context);
+    if(!batch.instances[item]->load_rom(batch.rom, batch.rom_size)) {
+        batch.rom_failures.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return false;
+}
+
+bool BatchRunner::step_instance(void* context, const size_t item, const size_t worker) {
+    BatchRunner& batch = *static_cast<BatchRunner*>(context);
+    NES& nes           = *batch.instances[item];
+
+    nes.set_input(batch.pending[item], 0x00);
+    nes.run_frame();
+    nes.ram.dump_block(batch.observation_address, &batch.observations[item * batch.observation_size], batch.observation_size);
+
+    return false;
+}
+
+bool BatchRunner::slice_instance(void* context, const size_t item, const size_t worker) {
+    BatchRunner& batch = *static_cast<BatchRunner*>(context);
+    NES& nes           = *batch.instances[item];
+    const u64 left     = batch.targets[item] - nes.cpu.cycles;
+
+    nes.run_cycles(left < batch.slice_cycles ? left : batch.slice_cycles);
+
+    return nes.cpu.cycles < batch.targets[item];
+}
\ No newline at end of file
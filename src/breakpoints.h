@@ -0,0 +1,720 @@
+#pragma once
+#include "cpu.h"
+#include "ram.h"
+#include "types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Breakpoints with conditions, which stop NES::run_cycles and NES::run_frame. A condition is compiled once, when its breakpoint is
+// added, into bytecode for a small stack machine, and is only evaluated when its trigger fires. Execute breakpoints set a bit in a PC
+// bitmap that the run loop tests before each instruction; read and write breakpoints are RAM watchpoints, so pages without one keep
+// the direct memory path. The run loop only looks at the bitmap while a Breakpoints is attached.
+//
+// Conditions, loosest binding first. Arithmetic is unsigned and 64 bits wide, and every comparison and logical operator gives 1 or 0:
+//   a || b    a && b                     short-circuiting
+//   ==  !=  <  <=  >  >=
+//   &  |  ^
+//   +  -
+//   !x  (x)  [x]                         [x] is the byte at address x, read without side effects
+//   a x y s sp pc cycles                 registers; s is the status register
+//   c z i d v n                          status flags
+//   address value                        the access that fired a read or write breakpoint
+//   $C000  0xC000  %1010  49152
+//
+// Execute breakpoints can be added from the condition alone when its top level && chain has a "pc == <number>" term, as in
+// "pc == $C000 && a > 10 && [$0300] == 5".
+struct Breakpoints {
+    static constexpr u8
+        READ    = RAM::WATCH_READ,
+        WRITE   = RAM::WATCH_WRITE,
+        EXECUTE = 1 << 2;
+
+    static constexpr size_t MAX_CODE     = 256; // Bytes of bytecode per condition
+    static constexpr size_t STACK_SIZE   = 16;
+    static constexpr size_t MAX_NESTING  = 32; // Brackets and ! operators open around any one term
+    static constexpr size_t MAX_ACCESSES = 4; // Watched accesses remembered per instruction
+
+    struct Breakpoint {
+        u64 hits;
+        u32 code;      // Offset of the compiled condition in the code pool
+        u32 code_size; // Zero for a breakpoint without a condition
+        u16 address;
+        u8 kind;
+        bool enabled;
+    };
+
+    struct Access {
+        u16 address;
+        u8 value;
+        u8 kind;
+    };
+
+    Breakpoint* breakpoints   = nullptr;
+    size_t count              = 0;
+    size_t capacity           = 0;
+    u8* code                  = nullptr; // Every condition's bytecode, back to back
+    size_t code_used          = 0;
+    size_t code_capacity      = 0;
+    u64 pc_bits[0x10000 / 64] = {};
+    RAM* ram                  = nullptr;
+    Access accesses[MAX_ACCESSES];
+    size_t access_count = 0;
+
+    bool stopped     = false; // Set when a breakpoint stopped the last run
+    u32 hit          = 0;     // The breakpoint that stopped it
+    bool resuming    = false;
+    u64 resume_cycle = 0;
+
+    char error[96]      = {}; // Why the last condition failed to compile
+    size_t error_column = 0;
+
+    Breakpoints() = default;
+    Breakpoints(const Breakpoints&)            = delete;
+    Breakpoints& operator=(const Breakpoints&) = delete;
+    ~Breakpoints();
+
+    // Read and write breakpoints need the RAM they watch, which must outlive them. Breakpoints then owns the RAM's watch state: it takes
+    // over the watch handler until it is destroyed, and removing a breakpoint clears the RAM watchpoint at its address.
+    void attach(RAM& memory);
+    void clear();
+
+    // Returns the breakpoint's id, or -1 with the reason in error
+    [[nodiscard]] int add(const u8 kind, const u16 address, const char* condition = nullptr);
+    [[nodiscard]] int add(const char* condition);
+    void remove(const int id);
+
+    // Called by the run loop before every instruction. Returns true to stop with the PC at that instruction; watched accesses stop the
+    // run after the instruction that made them.
+    [[nodiscard]] bool check(const CPU& cpu, const RAM& memory);
+    [[nodiscard]] u64 evaluate(const Breakpoint& breakpoint, const CPU& cpu, const RAM& memory, const Access& access) const;
+
+private:
+    enum class Op : u8 {
+        CONST, // u32 operand
+        A,
+        X,
+        Y,
+        S,
+        SP,
+        PC,
+        CYCLES,
+        ADDRESS,
+        VALUE,
+        FLAG, // u8 bit operand
+        LOAD,
+        NOT,
+        ADD,
+        SUB,
+        AND,
+        OR,
+        XOR,
+        EQ,
+        NE,
+        LT,
+        LE,
+        GT,
+        GE,
+        JUMP_IF_FALSE, // u16 target operand; keeps the value when jumping and pops it otherwise
+        JUMP_IF_TRUE,
+        BOOL,
+    };
+
+    struct Compiler {
+        const char* text;
+        const char* cursor;
+        u8 code[MAX_CODE];
+        u32 size;
+        u32 depth;
+        u32 max_depth;
+        u32 nesting;   // Brackets open around the current term
+        u32 recursion; // Brackets and ! operators open around the current term
+        bool failed;
+        bool alternatives; // A top level || makes the pc term optional
+        long pc_trigger;   // Address from a top level "pc == <number>" term, or -1
+        const char* message;
+        size_t column;
+
+        [[nodiscard]] bool compile(const char* condition);
+        void skip_space();
+        [[nodiscard]] bool match(const char* token);
+        void fail(const char* reason);
+        [[nodiscard]] bool enter();
+        void emit(const Op op, const int stack_change);
+        void emit_u8(const u8 value);
+        void emit_u16(const u16 value);
+        void emit_u32(const u32 value);
+        void patch_u16(const u32 offset, const u16 value);
+
+        void parse_or();
+        void parse_and();
+        void parse_comparison();
+        void parse_bitwise();
+        void parse_additive();
+        void parse_unary();
+        void parse_primary();
+        void parse_number();
+        void parse_name();
+        [[nodiscard]] long pc_term(const u32 start) const;
+    };
+
+    [[nodiscard]] bool compile(Compiler& compiler, const char* condition);
+    [[nodiscard]] int add_compiled(const u8 kind, const u16 address, const Compiler& compiler);
+    [[nodiscard]] bool triggered(const CPU& cpu, const RAM& memory, const bool at_pc);
+    [[nodiscard]] bool fires(const u32 index, const CPU& cpu, const RAM& memory, const Access& access);
+    void set_pc_bit(const u16 address);
+    static void on_watch(void* context, const u16 address, const u8 value, const u8 kind);
+};
+
+Breakpoints::~Breakpoints() {
+    clear();
+    if(ram) {
+        ram->set_watch_handler(nullptr, nullptr);
+    }
+}
+
+void Breakpoints::attach(RAM& memory) {
+    ram = &memory;
+    ram->set_watch_handler(on_watch, this);
+}
+
+void Breakpoints::clear() {
+    for(size_t i = 0; i < count; i++) {
+        remove(static_cast<int>(i));
+    }
+
+    free(breakpoints);
+    free(code);
+    breakpoints   = nullptr;
+    code          = nullptr;
+    count         = 0;
+    capacity      = 0;
+    code_used     = 0;
+    code_capacity = 0;
+    access_count  = 0;
+    stopped       = false;
+    hit           = 0;
+    resuming      = false;
+}
+
+bool Breakpoints::compile(Compiler& compiler, const char* condition) {
+    if(compiler.compile(condition ? condition : "")) return true;
+
+    snprintf(error, sizeof(error), "%s", compiler.message);
+    error_column = compiler.column;
+    return false;
+}
+
+int Breakpoints::add(const u8 kind, const u16 address, const char* condition) {
+    Compiler compiler;
+    if(!compile(compiler, condition)) return -1;
+
+    return add_compiled(kind, address, compiler);
+}
+
+int Breakpoints::add(const char* condition) {
+    Compiler compiler;
+    if(!compile(compiler, condition)) return -1;
+
+    if(compiler.alternatives || compiler.pc_trigger < 0) {
+        snprintf(error, sizeof(error), "no top level pc == <number> term to trigger on");
+        error_column = 0;
+        return -1;
+    }
+
+    return add_compiled(EXECUTE, static_cast<u16>(compiler.pc_trigger), compiler);
+}
+
+int Breakpoints::add_compiled(const u8 kind, const u16 address, const Compiler& compiler) {
+    const char* invalid = nullptr;
+    if(kind != EXECUTE && (!kind || (kind & ~(READ | WRITE)))) {
+        invalid = "a breakpoint is either execute, or read and/or write";
+    } else if(kind != EXECUTE && !ram) {
+        invalid = "read and write breakpoints need attached RAM";
+    }
+
+    if(invalid) {
+        snprintf(error, sizeof(error), "%s", invalid);
+        error_column = 0;
+        return -1;
+    }
+
+    if(count == capacity) {
+        capacity    = capacity ? capacity * 2 : 16;
+        breakpoints = static_cast<Breakpoint*>(realloc(breakpoints, capacity * sizeof(Breakpoint)));
+    }
+    if(code_used + compiler.size > code_capacity) {
+        while(code_used + compiler.size > code_capacity) {
+            code_capacity = code_capacity ? code_capacity * 2 : KB(1);
+        }
+        code = static_cast<u8*>(realloc(code, code_capacity));
+    }
+
+    memcpy(&code[code_used], compiler.code, compiler.size);
+    breakpoints[count] = {0, static_cast<u32>(code_used), compiler.size, address, kind, true};
+    code_used += compiler.size;
+
+    if(kind == EXECUTE) {
+        set_pc_bit(address);
+    } else {
+        ram->watch(address, kind);
+    }
+    return static_cast<int>(count++);
+}
+
+void Breakpoints::set_pc_bit(const u16 address) {
+    pc_bits[address >> 6] |= u64(1) << (address & 63);
+}
+
+void Breakpoints::remove(const int id) {
+    if(id < 0 || static_cast<size_t>(id) >= count || !breakpoints[id].enabled) return;
+
+    Breakpoint& removed = breakpoints[id];
+    removed.enabled     = false;
+
+    // Other breakpoints on the same address keep its trigger
+    u8 kinds = 0;
+    for(size_t i = 0; i < count; i++) {
+        if(breakpoints[i].enabled && breakpoints[i].address == removed.address) {
+            kinds |= breakpoints[i].kind;
+        }
+    }
+
+    if(removed.kind == EXECUTE && !(kinds & EXECUTE)) {
+        pc_bits[removed.address >> 6] &= ~(u64(1) << (removed.address & 63));
+    }
+    if(removed.kind != EXECUTE && ram) {
+        ram->unwatch(removed.address, static_cast<u8>(removed.kind & ~kinds));
+    }
+}
+
+bool Breakpoints::check(const CPU& cpu, const RAM& memory) {
+    const bool at_pc = (pc_bits[cpu.pc >> 6] >> (cpu.pc & 63)) & 1;
+    if(!at_pc && !access_count) return false;
+
+    return triggered(cpu, memory, at_pc);
+}
+
+bool Breakpoints::triggered(const CPU& cpu, const RAM& memory, const bool at_pc) {
+    const size_t pending = access_count;
+    access_count         = 0;
+
+    // The first check after an execute breakpoint stopped the run is for the same instruction, which has to run before it can stop again
+    const bool resumed = resuming && cpu.cycles == resume_cycle;
+    resuming           = false;
+
+    for(u32 i = 0; i < count; i++) {
+        const Breakpoint& breakpoint = breakpoints[i];
+        if(!breakpoint.enabled) continue;
+
+        if(breakpoint.kind == EXECUTE) {
+            if(at_pc && !resumed && breakpoint.address == cpu.pc && fires(i, cpu, memory, {cpu.pc, 0, EXECUTE})) return true;
+            continue;
+        }
+
+        for(size_t a = 0; a < pending; a++) {
+            if((accesses[a].kind & breakpoint.kind) && accesses[a].address == breakpoint.address && fires(i, cpu, memory, accesses[a])) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool Breakpoints::fires(const u32 index, const CPU& cpu, const RAM& memory, const Access& access) {
+    Breakpoint& breakpoint = breakpoints[index];
+    if(breakpoint.code_size && !evaluate(breakpoint, cpu, memory, access)) return false;
+
+    breakpoint.hits++;
+    stopped      = true;
+    hit          = index;
+    resuming     = breakpoint.kind == EXECUTE;
+    resume_cycle = cpu.cycles;
+    return true;
+}
+
+void Breakpoints::on_watch(void* context, const u16 address, const u8 value, const u8 kind) {
+    Breakpoints& self = *static_cast<Breakpoints*>(context);
+    if(self.access_count < MAX_ACCESSES) {
+        self.accesses[self.access_count++] = {address, value, kind};
+    }
+}
+
+u64 Breakpoints::evaluate(const Breakpoint& breakpoint, const CPU& cpu, const RAM& memory, const Access& access) const {
+    using enum Op;
+
+    const u8* program = &code[breakpoint.code];
+    u64 stack[STACK_SIZE];
+    size_t top = 0; // Next free slot
+    u32 ip     = 0;
+
+    while(ip < breakpoint.code_size) {
+        const Op op = static_cast<Op>(program[ip++]);
+        switch(op) {
+            case CONST: {
+                u32 value;
+                memcpy(&value, &program[ip], sizeof(value));
+                ip += sizeof(value);
+                stack[top++] = value;
+                break;
+            }
+            case A:       stack[top++] = cpu.a; break;
+            case X:       stack[top++] = cpu.x; break;
+            case Y:       stack[top++] = cpu.y; break;
+            case S:       stack[top++] = cpu.s; break;
+            case SP:      stack[top++] = cpu.sp; break;
+            case PC:      stack[top++] = cpu.pc; break;
+            case CYCLES:  stack[top++] = cpu.cycles; break;
+            case ADDRESS: stack[top++] = access.address; break;
+            case VALUE:   stack[top++] = access.value; break;
+            case FLAG:    stack[top++] = (cpu.s >> program[ip++]) & 1; break;
+            case LOAD:    stack[top - 1] = memory.peek(static_cast<u16>(stack[top - 1])); break;
+            case NOT:     stack[top - 1] = !stack[top - 1]; break;
+            case BOOL:    stack[top - 1] = stack[top - 1] != 0; break;
+            case ADD:     top--; stack[top - 1] += stack[top]; break;
+            case SUB:     top--; stack[top - 1] -= stack[top]; break;
+            case AND:     top--; stack[top - 1] &= stack[top]; break;
+            case OR:      top--; stack[top - 1] |= stack[top]; break;
+            case XOR:     top--; stack[top - 1] ^= stack[top]; break;
+            case EQ:      top--; stack[top - 1] = stack[top - 1] == stack[top]; break;
+            case NE:      top--; stack[top - 1] = stack[top - 1] != stack[top]; break;
+            case LT:      top--; stack[top - 1] = stack[top - 1] < stack[top]; break;
+            case LE:      top--; stack[top - 1] = stack[top - 1] <= stack[top]; break;
+            case GT:      top--; stack[top - 1] = stack[top - 1] > stack[top]; break;
+            case GE:      top--; stack[top - 1] = stack[top - 1] >= stack[top]; break;
+            case JUMP_IF_FALSE:
+            case JUMP_IF_TRUE: {
+                u16 target;
+                memcpy(&target, &program[ip], sizeof(target));
+                ip += sizeof(target);
+
+                if((stack[top - 1] != 0) == (op == JUMP_IF_TRUE)) {
+                    ip = target;
+                } else {
+                    top--;
+                }
+                break;
+            }
+        }
+    }
+
+    return top ? stack[top - 1] : 1;
+}
+
+bool Breakpoints::Compiler::compile(const char* condition) {
+    text         = condition;
+    cursor       = condition;
+    size         = 0;
+    depth        = 0;
+    max_depth    = 0;
+    nesting      = 0;
+    recursion    = 0;
+    failed       = false;
+    alternatives = false;
+    pc_trigger   = -1;
+    message      = nullptr;
+    column       = 0;
+
+    skip_space();
+    if(!*cursor) return true; // No condition
+
+    parse_or();
+    skip_space();
+    if(!failed && *cursor) {
+        fail("unexpected text after the condition");
+    }
+    if(!failed && max_depth > STACK_SIZE) {
+        fail("condition nests too deeply");
+    }
+    return !failed;
+}
+
+void Breakpoints::Compiler::skip_space() {
+    while(*cursor == ' ' || *cursor == '\t') {
+        cursor++;
+    }
+}
+
+bool Breakpoints::Compiler::match(const char* token) {
+    skip_space();
+
+    const size_t length = strlen(token);
+    if(strncmp(cursor, token, length) != 0) return false;
+
+    cursor += length;
+    return true;
+}
+
+void Breakpoints::Compiler::fail(const char* reason) {
+    if(!failed) {
+        failed  = true;
+        message = reason;
+        column  = static_cast<size_t>(cursor - text);
+    }
+}
+
+// Each bracket and ! recurses once, so their depth is limited before it can exhaust the host stack
+bool Breakpoints::Compiler::enter() {
+    if(recursion == MAX_NESTING) {
+        fail("condition nests too deeply");
+        return false;
+    }
+    recursion++;
+    return true;
+}
+
+void Breakpoints::Compiler::emit(const Op op, const int stack_change) {
+    emit_u8(static_cast<u8>(op));
+    depth = static_cast<u32>(static_cast<int>(depth) + stack_change);
+    if(depth > max_depth) {
+        max_depth = depth;
+    }
+}
+
+void Breakpoints::Compiler::emit_u8(const u8 value) {
+    if(size == MAX_CODE) {
+        fail("condition is too long");
+        return;
+    }
+    code[size++] = value;
+}
+
+void Breakpoints::Compiler::emit_u16(const u16 value) {
+    emit_u8(static_cast<u8>(value));
+    emit_u8(static_cast<u8>(value >> 8));
+}
+
+void Breakpoints::Compiler::emit_u32(const u32 value) {
+    emit_u16(static_cast<u16>(value));
+    emit_u16(static_cast<u16>(value >> 16));
+}
+
+void Breakpoints::Compiler::patch_u16(const u32 offset, const u16 value) {
+    if(offset + 2 <= size) {
+        code[offset]     = static_cast<u8>(value);
+        code[offset + 1] = static_cast<u8>(value >> 8);
+    }
+}
+
+void Breakpoints::Compiler::parse_or() {
+    parse_and();
+    while(!failed && match("||")) {
+        if(nesting == 0) {
+            alternatives = true;
+        }
+
+        emit(Op::JUMP_IF_TRUE, -1);
+        const u32 jump = size;
+        emit_u16(0);
+        parse_and();
+        patch_u16(jump, static_cast<u16>(size));
+        emit(Op::BOOL, 0);
+    }
+}
+
+void Breakpoints::Compiler::parse_and() {
+    u32 start = size;
+    parse_comparison();
+    if(nesting == 0 && pc_trigger < 0) {
+        pc_trigger = pc_term(start);
+    }
+
+    while(!failed && match("&&")) {
+        emit(Op::JUMP_IF_FALSE, -1);
+        const u32 jump = size;
+        emit_u16(0);
+
+        start = size;
+        parse_comparison();
+        if(nesting == 0 && pc_trigger < 0) {
+            pc_trigger = pc_term(start);
+        }
+
+        patch_u16(jump, static_cast<u16>(size));
+        emit(Op::BOOL, 0);
+    }
+}
+
+// The address of a "pc == <number>" or "<number> == pc" term compiled from start, or -1
+long Breakpoints::Compiler::pc_term(const u32 start) const {
+    if(size != start + 7 || code[start + 6] != static_cast<u8>(Op::EQ)) return -1;
+
+    const bool pc_first = code[start] == static_cast<u8>(Op::PC) && code[start + 1] == static_cast<u8>(Op::CONST);
+    const bool pc_last  = code[start] == static_cast<u8>(Op::CONST) && code[start + 5] == static_cast<u8>(Op::PC);
+    if(!pc_first && !pc_last) return -1;
+
+    u32 value;
+    memcpy(&value, &code[start + (pc_first ? 2 : 1)], sizeof(value));
+    return value <= 0xFFFF ? static_cast<long>(value) : -1;
+}
+
+void Breakpoints::Compiler::parse_comparison() {
+    parse_bitwise();
+
+    // Two character operators are matched first so that "<=" is not read as "<"
+    static constexpr struct {
+        const char* token;
+        Op op;
+    } operators[] = {{"==", Op::EQ}, {"!=", Op::NE}, {"<=", Op::LE}, {">=", Op::GE}, {"<", Op::LT}, {">", Op::GT}};
+
+    for(const auto& comparison : operators) {
+        if(match(comparison.token)) {
+            parse_bitwise();
+            emit(comparison.op, -1);
+            return;
+        }
+    }
+}
+
+void Breakpoints::Compiler::parse_bitwise() {
+    parse_additive();
+    while(!failed) {
+        skip_space();
+        // "&&" and "||" belong to the looser levels
+        const bool pair = cursor[0] && cursor[1] == cursor[0];
+        if(*cursor == '&' && !pair) {
+            cursor++;
+            parse_additive();
+            emit(Op::AND, -1);
+        } else if(*cursor == '|' && !pair) {
+            cursor++;
+            parse_additive();
+            emit(Op::OR, -1);
+        } else if(*cursor == '^') {
+            cursor++;
+            parse_additive();
+            emit(Op::XOR, -1);
+        } else {
+            return;
+        }
+    }
+}
+
+void Breakpoints::Compiler::parse_additive() {
+    parse_unary();
+    while(!failed) {
+        if(match("+")) {
+            parse_unary();
+            emit(Op::ADD, -1);
+        } else if(match("-")) {
+            parse_unary();
+            emit(Op::SUB, -1);
+        } else {
+            return;
+        }
+    }
+}
+
+void Breakpoints::Compiler::parse_unary() {
+    skip_space();
+    if(cursor[0] == '!' && cursor[1] != '=') {
+        if(!enter()) return;
+        cursor++;
+        parse_unary();
+        recursion--;
+        emit(Op::NOT, 0);
+        return;
+    }
+
+    parse_primary();
+}
+
+void Breakpoints::Compiler::parse_primary() {
+    skip_space();
+
+    const char c = *cursor;
+    if(c == '(' || c == '[') {
+        if(!enter()) return;
+        cursor++;
+        nesting++;
+        parse_or();
+        nesting--;
+        recursion--;
+
+        if(!match(c == '(' ? ")" : "]")) {
+            fail(c == '(' ? "expected )" : "expected ]");
+            return;
+        }
+        if(c == '[') {
+            emit(Op::LOAD, 0);
+        }
+    } else if(c == '$' || c == '%' || (c >= '0' && c <= '9')) {
+        parse_number();
+    } else if((c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z')) {
+        parse_name();
+    } else {
+        fail(c ? "expected a value" : "unexpected end of condition");
+    }
+}
+
+void Breakpoints::Compiler::parse_number() {
+    u32 base = 10;
+    if(*cursor == '$') {
+        base = 16;
+        cursor++;
+    } else if(*cursor == '%') {
+        base = 2;
+        cursor++;
+    } else if(cursor[0] == '0' && (cursor[1] == 'x' || cursor[1] == 'X')) {
+        base = 16;
+        cursor += 2;
+    }
+
+    u64 value  = 0;
+    u32 digits = 0;
+    for(;; cursor++, digits++) {
+        const char c    = *cursor;
+        const int digit = c >= '0' && c <= '9' ? c - '0' : (c >= 'A' && c <= 'F' ? c - 'A' + 10 : (c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1));
+        if(digit < 0 || static_cast<u32>(digit) >= base) break;
+
+        value = value * base + static_cast<u32>(digit);
+        if(value > 0xFFFFFFFF) {
+            fail("number is too large");
+            return;
+        }
+    }
+
+    if(!digits) {
+        fail("expected digits");
+        return;
+    }
+
+    emit(Op::CONST, 1);
+    emit_u32(static_cast<u32>(value));
+}
+
+void Breakpoints::Compiler::parse_name() {
+    char name[8];
+    size_t length = 0;
+    while((*cursor >= 'a' && *cursor <= 'z') || (*cursor >= 'A' && *cursor <= 'Z')) {
+        if(length < sizeof(name) - 1) {
+            name[length] = static_cast<char>(*cursor | 0x20); // Lower case
+        }
+        length++;
+        cursor++;
+    }
+    name[length < sizeof(name) ? length : 0] = '\0';
+
+    static constexpr struct {
+        const char* name;
+        Op op;
+        u8 bit;
+    } names[] = {
+        {"a", Op::A, 0}, {"x", Op::X, 0}, {"y", Op::Y, 0}, {"s", Op::S, 0}, {"sp", Op::SP, 0}, {"pc", Op::PC, 0}, {"cycles", Op::CYCLES, 0},
+        {"address", Op::ADDRESS, 0}, {"value", Op::VALUE, 0},
+        {"c", Op::FLAG, 0}, {"z", Op::FLAG, 1}, {"i", Op::FLAG, 2}, {"d", Op::FLAG, 3}, {"v", Op::FLAG, 6}, {"n", Op::FLAG, 7},
+    };
+
+    for(const auto& entry : names) {
+        if(strcmp(name, entry.name) == 0) {
+            emit(entry.op, 1);
+            if(entry.op == Op::FLAG) {
+                emit_u8(entry.bit);
+            }
+            return;
+        }
+    }
+
+    cursor -= length;
+    fail("unknown name");
+}
\ No newline at end of file
@@ -0,0 +1,211 @@
+#pragma once
+#include "types.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+// Records every bus access into a single-producer ring buffer. In STREAM mode a background thread drains the ring to a file in large
+// sequential writes and the bus waits for it only when the ring is full; in RECENT mode the ring simply overwrites its oldest entries
+// so that the last N accesses are always available for a post-mortem dump.
+struct BusTrace {
+    static constexpr u32 FILE_MAGIC   = 0x43525442; // "BTRC"
+    static constexpr u16 FILE_VERSION = 1;
+
+    static constexpr u8
+        READ  = 0,
+        WRITE = 1;
+
+    enum class Mode : u8 {
+        RECENT,
+        STREAM,
+    };
+
+    struct Record {
+        u32 cycle; // Low 32 bits of the CPU cycle counter at the start of the accessing instruction
+        u16 address;
+        u8 value;
+        u8 kind;
+    };
+    static_assert(sizeof(Record) == 8, "Trace records are written to disk as-is");
+
+    struct FileHeader {
+        u32 magic;
+        u16 version;
+        u16 record_size;
+    };
+
+    Record* records  = nullptr;
+    size_t capacity  = 0; // Always a power of two
+    Mode mode        = Mode::RECENT;
+    const u64* clock = nullptr;
+    std::atomic<u64> head; // Total records ever pushed
+    std::atomic<u64> tail; // Total records drained to disk (STREAM only)
+    std::atomic<bool> running;
+    std::thread writer;
+    FILE* file = nullptr;
+
+    BusTrace() = default;
+    BusTrace(const BusTrace&)            = delete;
+    BusTrace& operator=(const BusTrace&) = delete;
+    ~BusTrace();
+
+    void init(const size_t minimum_capacity, const u64* cycle_counter);
+    void shutdown();
+
+    [[nodiscard]] bool stream_to(const char* path);
+    void stop_stream();
+
+    void record(const u16 address, const u8 value, const u8 kind);
+    [[nodiscard]] size_t recent(Record* out, const size_t count) const;
+    [[nodiscard]] u16 most_recent(const u8 kind) const;
+    [[nodiscard]] bool dump_recent(const char* path, const size_t count) const;
+
+private:
+    void drain();
+};
+
+BusTrace::~BusTrace() {
+    shutdown();
+}
+
+void BusTrace::init(const size_t minimum_capacity, const u64* cycle_counter) {
+    shutdown();
+
+    capacity = 1;
+    while(capacity < minimum_capacity) {
+        capacity <<= 1;
+    }
+
+    records = new Record[capacity]{};
+    mode    = Mode::RECENT;
+    clock   = cycle_counter;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+}
+
+void BusTrace::shutdown() {
+    stop_stream();
+
+    delete[] records;
+    records  = nullptr;
+    capacity = 0;
+}
+
+bool BusTrace::stream_to(const char* path) {
+    stop_stream();
+
+    file = fopen(path, "wb");
+    if(!file) return false;
+
+    const FileHeader header = {FILE_MAGIC, FILE_VERSION, sizeof(Record)};
+    fwrite(&header, sizeof(header), 1, file);
+
+    tail.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    mode = Mode::STREAM;
+    running.store(true, std::memory_order_release);
+    writer = std::thread([this] { drain(); });
+
+    return true;
+}
+
+void BusTrace::stop_stream() {
+    if(writer.joinable()) {
+        running.store(false, std::memory_order_release);
+        writer.join();
+    }
+
+    if(file) {
+        fclose(file);
+        file = nullptr;
+    }
+
+    mode = Mode::RECENT;
+}
+
+void BusTrace::record(const u16 address, const u8 value, const u8 kind) {
+    const u64 index = head.load(std::memory_order_relaxed);
+
+    if(mode == Mode::STREAM) {
+        while(index - tail.load(std::memory_order_acquire) >= capacity) {
+            std::this_thread::yield();
+        }
+    }
+
+    records[index & (capacity - 1)] = {clock ? static_cast<u32>(*clock) : 0, address, value, kind};
+    head.store(index + 1, std::memory_order_release);
+}
+
+size_t BusTrace::recent(Record* out, const size_t count) const {
+    const u64 end   = head.load(std::memory_order_acquire);
+    const u64 total = end < capacity ? end : capacity;
+    const u64 n     = count < total ? count : total;
+
+    for(u64 i = 0; i < n; i++) {
+        out[i] = records[(end - n + i) & (capacity - 1)];
+    }
+
+    return static_cast<size_t>(n);
+}
+
+u16 BusTrace::most_recent(const u8 kind) const {
+    const u64 end   = head.load(std::memory_order_acquire);
+    const u64 total = end < capacity ? end : capacity;
+
+    for(u64 i = 1; i <= total; i++) {
+        const Record& record = records[(end - i) & (capacity - 1)];
+        if(record.kind == kind) {
+            return record.address;
+        }
+    }
+
+    return 0x0000;
+}
+
+bool BusTrace::dump_recent(const char* path, const size_t count) const {
+    FILE* out = fopen(path, "wb");
+    if(!out) return false;
+
+    const FileHeader header = {FILE_MAGIC, FILE_VERSION, sizeof(Record)};
+    fwrite(&header, sizeof(header), 1, out);
+
+    // Written straight out of the ring in at most two contiguous runs
+    const u64 end   = head.load(std::memory_order_acquire);
+    const u64 total = end < capacity ? end : capacity;
+    const u64 n     = count < total ? count : total;
+    const u64 first = (end - n) & (capacity - 1);
+    const u64 run   = (capacity - first < n) ? capacity - first : n;
+
+    fwrite(&records[first], sizeof(Record), static_cast<size_t>(run), out);
+    fwrite(records, sizeof(Record), static_cast<size_t>(n - run), out);
+
+    return fclose(out) == 0;
+}
+
+void BusTrace::drain() {
+    static constexpr u64 MIN_BATCH = KB(64) / sizeof(Record);
+
+    for(;;) {
+        const bool stopping = !running.load(std::memory_order_acquire);
+        const u64 start     = tail.load(std::memory_order_relaxed);
+        const u64 end       = head.load(std::memory_order_acquire);
+        const u64 available = end - start;
+
+        if(available == 0 && stopping) break;
+
+        // Wait for a reasonably large batch unless the producer is waiting on us or we are flushing for shutdown
+        if(available == 0 || (available < MIN_BATCH && available < capacity / 2 && !stopping)) {
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+
+        const u64 first = start & (capacity - 1);
+        const u64 run   = (capacity - first < available) ? capacity - first : available;
+
+        fwrite(&records[first], sizeof(Record), static_cast<size_t>(run), file);
+        tail.store(start + run, std::memory_order_release);
+    }
+
+    fflush(file);
+}
\ No newline at end of file
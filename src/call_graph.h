@@ -0,0 +1,306 @@
+#pragma once
+#include "ram.h"
+#include "symbols.h"
+#include "types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Call graph profile of the guest, built from a shadow call stack. Every JSR pushes a frame and every RTS or RTI pops one, and the
+// cycles between two such events are charged to the call path on top of the stack. Paths are interned in a tree, so the cost of an
+// event is one hash lookup and nothing is done for other instructions.
+//
+// Frames are matched to returns by the stack pointer rather than by order. A return pops its frame only when SP is exactly where the
+// call left it; frames whose return address has already been pulled off the stack (TXS, PLA/PLA) are discarded, and an RTS that
+// finds anything else on the stack is an RTS-as-jump and leaves the shadow stack alone. The CPU has no subroutine or interrupt
+// instructions yet, so events are recognised by opcode and the profiler starts seeing calls as soon as those handlers exist.
+struct CallGraph {
+    static constexpr u8
+        JSR = 0x20,
+        RTS = 0x60,
+        RTI = 0x40;
+
+    static constexpr size_t MAX_DEPTH = 256;
+
+    struct Node {
+        u64 exclusive; // Cycles spent with this path on top of the stack
+        u64 calls;
+        u32 parent;
+        u32 chain; // Next node in the same hash bucket
+        u16 routine;
+        bool interrupt;
+    };
+
+    struct Frame {
+        u32 node;
+        u8 sp; // SP after the return address was pushed
+        bool interrupt;
+    };
+
+    Node* nodes          = nullptr; // Node 0 is the code running when profiling started
+    size_t node_count    = 0;
+    size_t node_capacity = 0;
+    u32* buckets         = nullptr;
+    size_t bucket_mask   = 0;
+    Frame frames[MAX_DEPTH];
+    size_t depth   = 0;
+    u64 last_cycle = 0;
+    u64 overflows  = 0; // Calls made past MAX_DEPTH, which are charged to their caller
+    u64 discarded  = 0; // Frames dropped because the stack was unwound past them
+    u64 unmatched  = 0; // Returns that did not match the top frame, including every RTS used as a jump
+
+    CallGraph() = default;
+    CallGraph(const CallGraph&)            = delete;
+    CallGraph& operator=(const CallGraph&) = delete;
+    ~CallGraph();
+
+    void init(const u16 entry, const u64 cycle);
+    void shutdown();
+
+    // Called before every instruction executes
+    void step(const RAM& ram, const u16 pc, const u8 opcode, const u8 sp, const u64 cycle);
+    void interrupt(const u16 handler, const u8 sp, const u64 cycle);
+    void finish(const u64 cycle);
+
+    // One line per call path, "main;update;draw 1234", as read by flamegraph.pl and speedscope
+    void write_folded(FILE* file, const SymbolTable* symbols) const;
+    // Inclusive and exclusive cycles per routine, hottest first. Recursive calls are only counted once towards inclusive cycles.
+    void report(FILE* file, const SymbolTable* symbols, const size_t limit = 20) const;
+
+private:
+    void charge(const u64 cycle);
+    void push(const u16 routine, const u8 frame_sp, const bool interrupt_frame, const u64 cycle);
+    void pop(const u8 sp, const bool interrupt_frame, const u64 cycle);
+    void unwind(const u8 sp);
+    [[nodiscard]] u32 child(const u32 parent, const u16 routine, const bool interrupt_frame);
+    void rehash();
+    [[nodiscard]] u32 current() const;
+    [[nodiscard]] size_t bucket(const u32 parent, const u16 routine, const bool interrupt_frame) const;
+    static void print_name(FILE* file, const SymbolTable* symbols, const u16 address);
+};
+
+CallGraph::~CallGraph() {
+    shutdown();
+}
+
+void CallGraph::init(const u16 entry, const u64 cycle) {
+    shutdown();
+
+    node_capacity = 1024;
+    nodes         = static_cast<Node*>(malloc(node_capacity * sizeof(Node)));
+    bucket_mask   = node_capacity * 2 - 1;
+    buckets       = static_cast<u32*>(malloc((bucket_mask + 1) * sizeof(u32)));
+    memset(buckets, 0xFF, (bucket_mask + 1) * sizeof(u32));
+
+    nodes[0]   = {0, 1, 0, UINT32_MAX, entry, false};
+    node_count = 1;
+    depth      = 0;
+    last_cycle = cycle;
+    overflows  = 0;
+    discarded  = 0;
+    unmatched  = 0;
+}
+
+void CallGraph::shutdown() {
+    free(nodes);
+    free(buckets);
+    nodes         = nullptr;
+    buckets       = nullptr;
+    node_count    = 0;
+    node_capacity = 0;
+}
+
+void CallGraph::step(const RAM& ram, const u16 pc, const u8 opcode, const u8 sp, const u64 cycle) {
+    switch(opcode) {
+        case JSR:
+            push(static_cast<u16>(ram.peek(static_cast<u16>(pc + 1)) | (ram.peek(static_cast<u16>(pc + 2)) << 8)),
+                 static_cast<u8>(sp - 2), false, cycle);
+            break;
+        case RTS:
+            pop(sp, false, cycle);
+            break;
+        case RTI:
+            pop(sp, true, cycle);
+            break;
+        default:
+            break;
+    }
+}
+
+void CallGraph::interrupt(const u16 handler, const u8 sp, const u64 cycle) {
+    push(handler, static_cast<u8>(sp - 3), true, cycle);
+}
+
+void CallGraph::finish(const u64 cycle) {
+    charge(cycle);
+}
+
+u32 CallGraph::current() const {
+    return depth ? frames[depth - 1].node : 0;
+}
+
+void CallGraph::charge(const u64 cycle) {
+    nodes[current()].exclusive += cycle - last_cycle;
+    last_cycle = cycle;
+}
+
+// A frame whose return address sits below SP has been pulled off the stack by something other than its return
+void CallGraph::unwind(const u8 sp) {
+    while(depth && frames[depth - 1].sp < sp) {
+        depth--;
+        discarded++;
+    }
+}
+
+void CallGraph::push(const u16 routine, const u8 frame_sp, const bool interrupt_frame, const u64 cycle) {
+    charge(cycle);
+    unwind(static_cast<u8>(frame_sp + (interrupt_frame ? 3 : 2)));
+
+    if(depth == MAX_DEPTH) {
+        overflows++;
+        return;
+    }
+
+    const u32 node = child(current(), routine, interrupt_frame);
+    nodes[node].calls++;
+    frames[depth++] = {node, frame_sp, interrupt_frame};
+}
+
+void CallGraph::pop(const u8 sp, const bool interrupt_frame, const u64 cycle) {
+    charge(cycle);
+    unwind(sp);
+
+    if(depth && frames[depth - 1].sp == sp && frames[depth - 1].interrupt == interrupt_frame) {
+        depth--;
+    } else {
+        unmatched++;
+    }
+}
+
+size_t CallGraph::bucket(const u32 parent, const u16 routine, const bool interrupt_frame) const {
+    return ((static_cast<size_t>(parent) * 0x9E3779B1u) ^ routine ^ (interrupt_frame ? 0x10000 : 0)) & bucket_mask;
+}
+
+u32 CallGraph::child(const u32 parent, const u16 routine, const bool interrupt_frame) {
+    const size_t hash = bucket(parent, routine, interrupt_frame);
+    for(u32 node = buckets[hash]; node != UINT32_MAX; node = nodes[node].chain) {
+        if(nodes[node].parent == parent && nodes[node].routine == routine && nodes[node].interrupt == interrupt_frame) return node;
+    }
+
+    if(node_count == node_capacity) {
+        node_capacity *= 2;
+        nodes = static_cast<Node*>(realloc(nodes, node_capacity * sizeof(Node)));
+        rehash();
+        return child(parent, routine, interrupt_frame);
+    }
+
+    const u32 node = static_cast<u32>(node_count++);
+    nodes[node]    = {0, 0, parent, buckets[hash], routine, interrupt_frame};
+    buckets[hash]  = node;
+    return node;
+}
+
+void CallGraph::rehash() {
+    bucket_mask = node_capacity * 2 - 1;
+    buckets     = static_cast<u32*>(realloc(buckets, (bucket_mask + 1) * sizeof(u32)));
+    memset(buckets, 0xFF, (bucket_mask + 1) * sizeof(u32));
+
+    for(u32 node = 1; node < node_count; node++) {
+        const size_t hash = bucket(nodes[node].parent, nodes[node].routine, nodes[node].interrupt);
+        nodes[node].chain = buckets[hash];
+        buckets[hash]     = node;
+    }
+}
+
+void CallGraph::print_name(FILE* file, const SymbolTable* symbols, const u16 address) {
+    const SymbolTable::Symbol* symbol = symbols ? symbols->exact(address) : nullptr;
+    if(symbol) {
+        fprintf(file, "%s", symbols->name(*symbol));
+    } else {
+        fprintf(file, "$%4.4X", address);
+    }
+}
+
+void CallGraph::write_folded(FILE* file, const SymbolTable* symbols) const {
+    u32 path[MAX_DEPTH + 1];
+    for(u32 node = 0; node < node_count; node++) {
+        if(!nodes[node].exclusive) continue;
+
+        size_t length = 0;
+        for(u32 walk = node; walk != 0; walk = nodes[walk].parent) {
+            path[length++] = walk;
+        }
+        path[length++] = 0;
+
+        for(size_t i = length; i-- > 0;) {
+            print_name(file, symbols, nodes[path[i]].routine);
+            if(nodes[path[i]].interrupt) {
+                fprintf(file, " [interrupt]");
+            }
+            fprintf(file, "%s", i ? ";" : "");
+        }
+        fprintf(file, " %llu\n", (unsigned long long)nodes[node].exclusive);
+    }
+}
+
+void CallGraph::report(FILE* file, const SymbolTable* symbols, const size_t limit) const {
+    struct Totals {
+        u64 inclusive;
+        u64 exclusive;
+        u64 calls;
+        u32 seen; // Last node whose path counted this routine, so recursion is only counted once
+    };
+
+    Totals* totals = new Totals[0x10000]();
+    u64 total      = 0;
+    for(u32 node = 0; node < node_count; node++) {
+        const u64 cycles = nodes[node].exclusive;
+        total += cycles;
+        totals[nodes[node].routine].exclusive += cycles;
+        totals[nodes[node].routine].calls += nodes[node].calls;
+
+        for(u32 walk = node;; walk = nodes[walk].parent) {
+            Totals& routine = totals[nodes[walk].routine];
+            if(routine.seen != node + 1) {
+                routine.seen = node + 1;
+                routine.inclusive += cycles;
+            }
+            if(walk == 0) break;
+        }
+    }
+
+    struct Entry {
+        u64 inclusive;
+        u16 routine;
+    };
+    auto compare = [](const void* left, const void* right) {
+        const Entry* a = static_cast<const Entry*>(left);
+        const Entry* b = static_cast<const Entry*>(right);
+        if(a->inclusive != b->inclusive) return a->inclusive > b->inclusive ? -1 : 1;
+        return a->routine < b->routine ? -1 : (a->routine > b->routine ? 1 : 0);
+    };
+
+    Entry* order = new Entry[0x10000];
+    size_t count = 0;
+    for(u32 routine = 0; routine < 0x10000; routine++) {
+        if(totals[routine].inclusive) {
+            order[count++] = {totals[routine].inclusive, static_cast<u16>(routine)};
+        }
+    }
+    qsort(order, count, sizeof(Entry), compare);
+
+    fprintf(file, "Call graph: %llu cycles, %zu paths, %llu unmatched returns, %llu discarded frames\n", (unsigned long long)total,
+            node_count, (unsigned long long)unmatched, (unsigned long long)discarded);
+    fprintf(file, "  inclusive  exclusive      calls  routine\n");
+    for(size_t i = 0; i < count && i < limit; i++) {
+        const Totals& routine = totals[order[i].routine];
+        const double scale    = total ? 100.0 / static_cast<double>(total) : 0.0;
+        fprintf(file, "  %8.2f%%  %8.2f%% %10llu  ", static_cast<double>(routine.inclusive) * scale,
+                static_cast<double>(routine.exclusive) * scale, (unsigned long long)routine.calls);
+        print_name(file, symbols, order[i].routine);
+        fprintf(file, "\n");
+    }
+
+    delete[] order;
+    delete[] totals;
+}
\ No newline at end of file
@@ -0,0 +1,166 @@
+#pragma once
+#include "opcodes.h"
+#include "ram.h"
+#include "types.h"
+#include <stdio.h>
+#include <string.h>
+
+// Code/data log: one byte of flags per CPU address, recording how the byte has been used. Saved logs use the FCEUX .cdl layout, one
+// byte per PRG ROM byte followed by one per CHR ROM byte, so they can be exchanged with FCEUX and the tools built around it.
+//
+// CPU::execute hands every instruction to the log before it runs, and the log decodes it from the opcode table: the instruction bytes
+// are marked as code and the bytes it reads, if any, as data. That costs a table lookup, a switch and a few peeks per instruction, but
+// only while a log is attached; doing it once per instruction rather than in the CPU's read helpers keeps the interpreter's memory
+// accesses free of any check otherwise. Reads made outside an instruction, by OAM DMA and the reset vector fetch, are marked by the
+// code making them through log_data. FCEUX leaves bit 7 of PRG bytes unused; here it marks the first byte of an instruction, so
+// recompilers can find instruction boundaries directly.
+struct CodeDataLog {
+    static constexpr u8
+        CODE          = 1 << 0, // Executed, as opcode or operand
+        DATA          = 1 << 1, // Read as data
+        BANK_MASK     = 3 << 2, // Which 8 KB window of $8000-$FFFF the byte was accessed through, filled in when saving
+        INDIRECT_CODE = 1 << 4, // Jumped to through a pointer, by JMP ($nnnn)
+        INDIRECT_DATA = 1 << 5, // Read through a pointer, by the ($nn,X) and ($nn),Y modes
+        PCM_DATA      = 1 << 6, // Played back by the DMC; unused until there is an APU
+        OPCODE        = 1 << 7;
+
+    static constexpr u16 PRG_ROM = 0x8000;
+
+    u8 flags[0x10000];
+
+    void clear();
+    void log_instruction(const RAM& ram, const u16 pc, const u8 opcode, const u8 x, const u8 y);
+    void log_data(const u16 address, const size_t size);
+
+    // Mapper 0 only: PRG ROM fills $8000-$FFFF, and a 16 KB image is mirrored into $C000, so both mirrors fold onto the same bytes.
+    // CHR bytes are written as zero without a PPU. Loading ORs an existing log into this one, so logs can be built up over runs.
+    [[nodiscard]] bool save(const char* path, const size_t prg_size, const size_t chr_size) const;
+    [[nodiscard]] bool load(const char* path, const size_t prg_size);
+    void export_prg(u8* out, const size_t prg_size) const;
+    void import_prg(const u8* data, const size_t prg_size);
+
+private:
+    [[nodiscard]] static bool reads_operand(const OpcodeInfo& info);
+};
+
+void CodeDataLog::clear() {
+    memset(flags, 0, sizeof(flags));
+}
+
+// Stores write their operand and JMP/JSR jump to it; everything else with a memory operand reads it
+bool CodeDataLog::reads_operand(const OpcodeInfo& info) {
+    return info.mnemonic[0] != 'J' && !(info.mnemonic[0] == 'S' && info.mnemonic[1] == 'T');
+}
+
+void CodeDataLog::log_instruction(const RAM& ram, const u16 pc, const u8 opcode, const u8 x, const u8 y) {
+    const OpcodeInfo& info = Opcodes::info(opcode);
+    const u8 length        = Opcodes::length(opcode);
+
+    flags[pc] |= CODE | OPCODE;
+    for(u8 i = 1; i < length; i++) {
+        flags[static_cast<u16>(pc + i)] |= CODE;
+    }
+
+    const u8 low   = ram.peek(static_cast<u16>(pc + 1));
+    const u16 word = static_cast<u16>(low | (ram.peek(static_cast<u16>(pc + 2)) << 8));
+    auto pointer   = [&ram](const u8 address) {
+        return static_cast<u16>(ram.peek(address) | (ram.peek(static_cast<u8>(address + 1)) << 8));
+    };
+
+    switch(info.mode) {
+        case AddressingMode::ZP:
+        case AddressingMode::ZPX:
+        case AddressingMode::ZPY:
+        case AddressingMode::ABS:
+        case AddressingMode::ABSX:
+        case AddressingMode::ABSY: {
+            if(!reads_operand(info)) break;
+
+            const bool zero_page = info.mode == AddressingMode::ZP || info.mode == AddressingMode::ZPX || info.mode == AddressingMode::ZPY;
+            const bool by_x      = info.mode == AddressingMode::ZPX || info.mode == AddressingMode::ABSX;
+            const bool by_y      = info.mode == AddressingMode::ZPY || info.mode == AddressingMode::ABSY;
+            const u16 base       = zero_page ? low : word;
+            const u16 address    = static_cast<u16>(base + (by_x ? x : 0) + (by_y ? y : 0));
+            flags[zero_page ? static_cast<u8>(address) : address] |= DATA;
+            break;
+        }
+        case AddressingMode::IND: {
+            // The pointer's high byte does not carry into the next page, as on hardware
+            const u16 high = static_cast<u16>((word & 0xFF00) | ((word + 1) & 0x00FF));
+            flags[word] |= DATA;
+            flags[high] |= DATA;
+            flags[static_cast<u16>(ram.peek(word) | (ram.peek(high) << 8))] |= INDIRECT_CODE;
+            break;
+        }
+        case AddressingMode::INDX:
+        case AddressingMode::INDY: {
+            const u8 zero_page = info.mode == AddressingMode::INDX ? static_cast<u8>(low + x) : low;
+            const u16 address  = static_cast<u16>(pointer(zero_page) + (info.mode == AddressingMode::INDY ? y : 0));
+            flags[zero_page] |= DATA;
+            flags[static_cast<u8>(zero_page + 1)] |= DATA;
+            if(reads_operand(info)) {
+                flags[address] |= DATA | INDIRECT_DATA;
+            }
+            break;
+        }
+        default:
+            break;
+    }
+}
+
+void CodeDataLog::log_data(const u16 address, const size_t size) {
+    for(size_t i = 0; i < size; i++) {
+        flags[static_cast<u16>(address + i)] |= DATA;
+    }
+}
+
+void CodeDataLog::export_prg(u8* out, const size_t prg_size) const {
+    memset(out, 0, prg_size);
+    if(!prg_size) return;
+
+    for(u32 address = PRG_ROM; address < 0x10000; address++) {
+        const u8 used = flags[address];
+        if(!used) continue;
+
+        const u8 bank = static_cast<u8>(((address >> 13) & 3) << 2);
+        out[(address - PRG_ROM) % prg_size] |= used | bank;
+    }
+}
+
+void CodeDataLog::import_prg(const u8* data, const size_t prg_size) {
+    if(!prg_size) return;
+
+    for(u32 address = PRG_ROM; address < 0x10000; address++) {
+        flags[address] |= static_cast<u8>(data[(address - PRG_ROM) % prg_size] & ~BANK_MASK);
+    }
+}
+
+bool CodeDataLog::save(const char* path, const size_t prg_size, const size_t chr_size) const {
+    FILE* file = fopen(path, "wb");
+    if(!file) return false;
+
+    u8* data = new u8[prg_size + chr_size];
+    export_prg(data, prg_size);
+    memset(&data[prg_size], 0, chr_size);
+
+    const bool written = fwrite(data, 1, prg_size + chr_size, file) == prg_size + chr_size;
+    delete[] data;
+
+    return (fclose(file) == 0) && written;
+}
+
+bool CodeDataLog::load(const char* path, const size_t prg_size) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return false;
+
+    u8* data         = new u8[prg_size];
+    const bool valid = fread(data, 1, prg_size, file) == prg_size;
+    fclose(file);
+
+    if(valid) {
+        import_prg(data, prg_size);
+    }
+    delete[] data;
+
+    return valid;
+}
\ No newline at end of file
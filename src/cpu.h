@@ -1,5 +1,10 @@
 #pragma once
+#include "call_graph.h"
+#include "code_data_log.h"
+#include "cpu_trace.h"
+#include "opcode_profile.h"
 #include "ram.h"
+#include "trace_log.h"
 #include "types.h"
 #include "utils.h"
 #include <stdio.h>
@@ -19,11 +24,22 @@ struct CPU {
         NEGATIVE_FLAG  = 1 << 7,
         ALL_FLAGS      = 0xFF;
 
-    u16 pc;                                             // Program Counter
-    u8 sp;                                              // Stack Pointer
-    u8 a, x, y, s;                                      // Registers
-    void (*instructions[MAX_INSTRUCTIONS])(CPU&, RAM&); // Instruction table
-    bool debug = false;
+    using Instruction = void (*)(CPU&, RAM&);
+
+    u16 pc;                          // Program Counter
+    u8 sp;                           // Stack Pointer
+    u8 a, x, y, s;                   // Registers
+    u64 cycles;                      // Elapsed CPU cycles
+    const Instruction* instructions; // Instruction table, shared between CPUs
+    u16 instruction_pc;              // Address of the opcode being executed
+    bool debug            = false;
+    CPUTrace* trace       = nullptr; // Receives debug output instead of stdout when attached
+    TraceLog* trace_log   = nullptr; // Logs every instruction in the nestest.log format when attached
+    CallGraph* call_graph = nullptr; // Follows subroutine calls and returns when attached
+    CodeDataLog* cdl      = nullptr; // Marks executed and read bytes when attached
+#if defined(NES_PROFILE)
+    OpcodeProfile* profile = nullptr; // Counts every instruction when attached
+#endif
 
     void execute(RAM& ram);
     void execute_instructions(RAM& ram, const size_t instruction_count = 1);
@@ -33,6 +49,7 @@ struct CPU {
     [[nodiscard]] u16 next_word(RAM& ram);
     void write_byte(RAM& ram, const u16 address, const u8 data) const;
     void reset();
+    void detach_observers(); // Detaches the trace, log, call graph, code/data log and profile
     [[nodiscard]] bool has_status(const u8 flags) const;
     void set_status(const u8 flags, const bool set);
     void update_status(const u8 address, const u8 flags);
@@ -43,13 +60,32 @@ struct CPU {
         u8 value                = 0x00;
     };
 
-    void debug_print_instruction(const DebugData& data = {}) const;
+    void debug_print_instruction(const DebugData& data) const;
 };
 
 void CPU::execute(RAM& ram) {
-    u8 opcode = read_byte(ram);
+    if(trace_log) {
+        trace_log->write({cycles, pc, a, x, y, s, sp});
+    }
+
+    instruction_pc = pc;
+    u8 opcode      = read_byte(ram);
+    if(cdl) {
+        cdl->log_instruction(ram, pc, opcode, x, y);
+    }
+    if(call_graph) {
+        call_graph->step(ram, instruction_pc, opcode, sp, cycles);
+    }
     pc++;
+#if defined(NES_PROFILE)
+    const u64 start = cycles;
+    instructions[opcode](*this, ram);
+    if(profile) {
+        profile->record(opcode, cycles - start);
+    }
+#else
     instructions[opcode](*this, ram);
+#endif
 }
 
 void CPU::execute_instructions(RAM& ram, const size_t instruction_count) {
@@ -82,7 +118,18 @@ void CPU::write_byte(RAM& ram, const u16 address, const u8 data) const {
 }
 
 void CPU::reset() {
-    pc = sp = a = x = y = s = 0x00;
+    pc     = sp = a = x = y = s = 0x00;
+    cycles = 0;
+}
+
+void CPU::detach_observers() {
+    trace      = nullptr;
+    trace_log  = nullptr;
+    call_graph = nullptr;
+    cdl        = nullptr;
+#if defined(NES_PROFILE)
+    profile = nullptr;
+#endif
 }
 
 bool CPU::has_status(const u8 flags) const {
@@ -110,6 +157,22 @@ void CPU::update_status(const u8 address, const u8 flags) {
 void CPU::debug_print_instruction(const DebugData& data) const {
     if(!debug) return;
 
+    if(trace) {
+        CPUTrace::Record record = {};
+        record.cycle            = cycles;
+        record.mnemonic         = data.instruction;
+        record.pc               = instruction_pc;
+        record.address          = data.address;
+        record.value            = data.value;
+        record.a                = a;
+        record.x                = x;
+        record.y                = y;
+        record.sp               = sp;
+        record.s                = s;
+        trace->record(record);
+        return;
+    }
+
     printf(
         "[%-*s] 0x%4.4x (%5i) |||||||||| REGISTERS: [PC] 0x%4.4x [SP] 0x%2.2x [A] 0x%2.2x (%3i) | [X] 0x%2.2x (%3i) | [Y] 0x%2.2x (%3i) |||||||||||| FLAGS: [N] %c [V] %c [~] %c [B] %c [D] %c [I] %c [Z] %c [C] %c\n",
         8,
@@ -0,0 +1,232 @@
+#pragma once
+#include "ram.h"
+#include "types.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+#include <thread>
+
+// Instruction trace for CPU debug output. While a trace is attached to a CPU with debug enabled, every instruction pushes one fixed
+// size record into a single-producer ring instead of calling printf, and a background thread formats the records to a file in large
+// batches. The emulation thread never waits on the formatter or the file: when the ring is full the record is dropped and counted,
+// and the count is written at the end of the trace.
+struct CPUTrace {
+    struct Record {
+        u64 cycle;            // CPU cycle counter after the instruction
+        const char* mnemonic; // The handler's string literal
+        u16 pc;               // Address of the opcode
+        u16 address;          // Effective address, when the instruction has one
+        u8 opcode;
+        u8 operands[2];       // The two bytes after the opcode, whether or not the instruction uses them
+        u8 value;
+        u8 a, x, y, sp, s;
+        u8 reserved[3];
+    };
+    static_assert(sizeof(Record) == 32, "Trace records should stay half a cache line");
+
+    static constexpr size_t LINE_SIZE = 160;
+
+    Record* records       = nullptr;
+    size_t capacity       = 0; // Always a power of two
+    const RAM* memory     = nullptr;
+    std::atomic<u64> head;     // Total records ever pushed
+    std::atomic<u64> tail;     // Total records formatted
+    std::atomic<u64> dropped;
+    std::atomic<bool> running;
+    std::thread formatter;
+    FILE* file = nullptr;
+
+    CPUTrace() = default;
+    CPUTrace(const CPUTrace&)            = delete;
+    CPUTrace& operator=(const CPUTrace&) = delete;
+    ~CPUTrace();
+
+    // Instruction bytes are read from ram without going through the bus, so tracing never triggers watchpoints or I/O
+    void init(const size_t minimum_capacity, const RAM* ram);
+    void shutdown();
+
+    [[nodiscard]] bool stream_to(const char* path);
+    void stop_stream();
+
+    void record(Record& record);
+    static int format(const Record& record, char* out, const size_t size);
+
+private:
+    void drain();
+};
+
+CPUTrace::~CPUTrace() {
+    shutdown();
+}
+
+void CPUTrace::init(const size_t minimum_capacity, const RAM* ram) {
+    shutdown();
+
+    capacity = 1;
+    while(capacity < minimum_capacity) {
+        capacity <<= 1;
+    }
+
+    records = new Record[capacity]{};
+    memory  = ram;
+    head.store(0, std::memory_order_relaxed);
+    tail.store(0, std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+}
+
+void CPUTrace::shutdown() {
+    stop_stream();
+
+    delete[] records;
+    records  = nullptr;
+    capacity = 0;
+}
+
+bool CPUTrace::stream_to(const char* path) {
+    stop_stream();
+
+    file = fopen(path, "wb");
+    if(!file) return false;
+
+    tail.store(head.load(std::memory_order_relaxed), std::memory_order_relaxed);
+    dropped.store(0, std::memory_order_relaxed);
+    running.store(true, std::memory_order_release);
+    formatter = std::thread([this] { drain(); });
+
+    return true;
+}
+
+void CPUTrace::stop_stream() {
+    if(formatter.joinable()) {
+        running.store(false, std::memory_order_release);
+        formatter.join();
+    }
+
+    if(file) {
+        const u64 lost = dropped.load(std::memory_order_relaxed);
+        if(lost) {
+            fprintf(file, "%llu records dropped\n", static_cast<unsigned long long>(lost));
+        }
+        fclose(file);
+        file = nullptr;
+    }
+}
+
+void CPUTrace::record(Record& record) {
+    const u64 index = head.load(std::memory_order_relaxed);
+    if(!file || index - tail.load(std::memory_order_acquire) >= capacity) {
+        dropped.fetch_add(file ? 1 : 0, std::memory_order_relaxed);
+        return;
+    }
+
+    if(memory) {
+        record.opcode      = memory->peek(record.pc);
+        record.operands[0] = memory->peek(static_cast<u16>(record.pc + 1));
+        record.operands[1] = memory->peek(static_cast<u16>(record.pc + 2));
+    }
+
+    records[index & (capacity - 1)] = record;
+    head.store(index + 1, std::memory_order_release);
+}
+
+int CPUTrace::format(const Record& record, char* out, const size_t size) {
+    // Hand rolled rather than snprintf: the formatter has to keep up with the emulation thread
+    static constexpr char HEX[] = "0123456789ABCDEF";
+
+    char line[LINE_SIZE];
+    char* cursor = line;
+
+    auto hex = [&cursor](const u32 value, const int digits) {
+        for(int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+            *cursor++ = HEX[(value >> shift) & 0xF];
+        }
+    };
+    auto text = [&cursor](const char* string) {
+        while(*string) {
+            *cursor++ = *string++;
+        }
+    };
+
+    const char* mnemonic = record.mnemonic ? record.mnemonic : "NULL";
+
+    hex(record.pc, 4);
+    text("  ");
+    hex(record.opcode, 2);
+    text(" ");
+    hex(record.operands[0], 2);
+    text(" ");
+    hex(record.operands[1], 2);
+    text("  ");
+    const char* padded = cursor + 8;
+    text(mnemonic);
+    while(cursor < padded) {
+        *cursor++ = ' ';
+    }
+    text(" $");
+    hex(record.address, 4);
+    text(" = ");
+    hex(record.value, 2);
+    text("  A:");
+    hex(record.a, 2);
+    text(" X:");
+    hex(record.x, 2);
+    text(" Y:");
+    hex(record.y, 2);
+    text(" P:");
+    hex(record.s, 2);
+    text(" SP:");
+    hex(record.sp, 2);
+    text(" CYC:");
+
+    char digits[20];
+    int count = 0;
+    u64 cycle = record.cycle;
+    do {
+        digits[count++] = static_cast<char>('0' + cycle % 10);
+        cycle /= 10;
+    } while(cycle);
+    while(count) {
+        *cursor++ = digits[--count];
+    }
+    *cursor++ = '\n';
+
+    const size_t length = static_cast<size_t>(cursor - line);
+    const size_t copied = length < size ? length : size - 1;
+    memcpy(out, line, copied);
+    out[copied] = '\0';
+
+    return static_cast<int>(length);
+}
+
+void CPUTrace::drain() {
+    static constexpr size_t BUFFER_SIZE = KB(256);
+
+    char* buffer = new char[BUFFER_SIZE];
+    for(;;) {
+        const bool stopping = !running.load(std::memory_order_acquire);
+        const u64 start     = tail.load(std::memory_order_relaxed);
+        const u64 end       = head.load(std::memory_order_acquire);
+
+        if(start == end) {
+            if(stopping) break;
+            std::this_thread::sleep_for(std::chrono::microseconds(100));
+            continue;
+        }
+
+        // Records are released back to the producer as soon as they are formatted, before the batch is written
+        size_t used = 0;
+        u64 index   = start;
+        while(index < end && used + LINE_SIZE <= BUFFER_SIZE) {
+            const int length = format(records[index & (capacity - 1)], &buffer[used], LINE_SIZE);
+            used += length < static_cast<int>(LINE_SIZE) ? length : LINE_SIZE - 1;
+            index++;
+        }
+        tail.store(index, std::memory_order_release);
+
+        fwrite(buffer, 1, used, file);
+    }
+
+    fflush(file);
+    delete[] buffer;
+}
\ No newline at end of file
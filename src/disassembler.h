@@ -0,0 +1,228 @@
+#pragma once
+#include "opcodes.h"
+#include "ram.h"
+#include "symbols.h"
+#include "types.h"
+
+// Static disassembly driven by the opcode table, for listings of the whole address space or of PRG ROM images. Lines use the same
+// columns as TraceLog, without the register state, and operands that land on a label are written as the label:
+//
+//   reset:
+//   C000  4C F5 C5  JMP main
+//
+// Everything is formatted straight into the caller's buffer, so a listing costs no allocation at all. Bytes that are not an official
+// opcode, and instructions cut off by the end of the input, are written as .byte lines and disassembly carries on at the next byte.
+struct Disassembler {
+    static constexpr size_t DISASSEMBLY_COLUMN = 16;
+    static constexpr size_t MAX_LABEL          = 48; // Longer labels are cut short
+    static constexpr size_t LABEL_SIZE         = MAX_LABEL + 2;
+    static constexpr size_t LINE_SIZE          = DISASSEMBLY_COLUMN + MAX_LABEL + 16;
+
+    const SymbolTable* symbols = nullptr;
+
+    // One instruction line, NUL terminated and without a newline. bytes must hold the instruction's operands; the length is returned.
+    u8 instruction(const u8* bytes, const u16 address, char* out) const;
+    u8 instruction(const RAM& ram, const u16 address, char* out) const;
+
+    // Disassembles [start, end) of the address space, reading it without side effects, as far as capacity allows; end is clamped to
+    // $10000. Returns the number of characters written. next is where a later call should carry on and reaches end once the range is
+    // done, or passes it by up to two bytes when the last instruction straddles end, since instructions are always decoded whole.
+    size_t disassemble(const RAM& ram, const u32 start, const u32 end, char* out, const size_t capacity, u32& next) const;
+    // Disassembles a ROM image mapped at base, such as a 16 KB PRG bank at $C000. consumed counts the bytes disassembled.
+    size_t disassemble(const u8* data, const size_t size, const u16 base, char* out, const size_t capacity, size_t& consumed) const;
+
+private:
+    static constexpr size_t WINDOW = 4096; // Bytes of RAM copied out per pass
+
+    size_t disassemble(const u8* data, const size_t size, const size_t available, const u16 base, char* out, const size_t capacity,
+                       size_t& consumed) const;
+    char* format(const u8* bytes, const u8 length, const u16 address, char* cursor) const;
+    char* operand(const u16 value, const int digits, char* cursor) const;
+    char* name(const SymbolTable::Symbol& symbol, char* cursor) const;
+    static char* hex(const u32 value, const int digits, char* cursor);
+    static char* text(const char* string, char* cursor);
+};
+
+char* Disassembler::hex(const u32 value, const int digits, char* cursor) {
+    static constexpr char HEX[] = "0123456789ABCDEF";
+    for(int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+        *cursor++ = HEX[(value >> shift) & 0xF];
+    }
+    return cursor;
+}
+
+char* Disassembler::text(const char* string, char* cursor) {
+    while(*string) {
+        *cursor++ = *string++;
+    }
+    return cursor;
+}
+
+// An address operand, as its label when it has one
+char* Disassembler::operand(const u16 value, const int digits, char* cursor) const {
+    const SymbolTable::Symbol* symbol = symbols ? symbols->exact(value) : nullptr;
+    if(!symbol) {
+        *cursor++ = '$';
+        return hex(value, digits, cursor);
+    }
+
+    return name(*symbol, cursor);
+}
+
+char* Disassembler::name(const SymbolTable::Symbol& symbol, char* cursor) const {
+    const char* label = symbols->name(symbol);
+    for(size_t i = 0; label[i] && i < MAX_LABEL; i++) {
+        *cursor++ = label[i];
+    }
+    return cursor;
+}
+
+// length is 1 for bytes written as .byte, whatever their opcode
+char* Disassembler::format(const u8* bytes, const u8 length, const u16 address, char* cursor) const {
+    char* line = cursor;
+
+    const u8 opcode        = bytes[0];
+    const OpcodeInfo& info = Opcodes::info(opcode);
+    const u8 low           = length > 1 ? bytes[1] : 0;
+    const u16 word         = static_cast<u16>(low | ((length > 2 ? bytes[2] : 0) << 8));
+
+    cursor = hex(address, 4, cursor);
+    cursor = text("  ", cursor);
+    cursor = hex(opcode, 2, cursor);
+    for(u8 i = 1; i < length; i++) {
+        *cursor++ = ' ';
+        cursor    = hex(bytes[i], 2, cursor);
+    }
+    while(cursor < line + DISASSEMBLY_COLUMN) {
+        *cursor++ = ' ';
+    }
+
+    if(length != Opcodes::length(opcode) || info.mode == AddressingMode::NONE) {
+        cursor = text(".byte $", cursor);
+        return hex(opcode, 2, cursor);
+    }
+
+    cursor = text(info.mnemonic, cursor);
+    switch(info.mode) {
+        case AddressingMode::IMP:
+        case AddressingMode::NONE:
+            break;
+        case AddressingMode::ACC:
+            cursor = text(" A", cursor);
+            break;
+        case AddressingMode::IMM:
+            cursor = text(" #$", cursor);
+            cursor = hex(low, 2, cursor);
+            break;
+        case AddressingMode::ZP:
+        case AddressingMode::ZPX:
+        case AddressingMode::ZPY:
+            *cursor++ = ' ';
+            cursor    = operand(low, 2, cursor);
+            cursor    = text(info.mode == AddressingMode::ZP ? "" : (info.mode == AddressingMode::ZPX ? ",X" : ",Y"), cursor);
+            break;
+        case AddressingMode::ABS:
+        case AddressingMode::ABSX:
+        case AddressingMode::ABSY:
+            *cursor++ = ' ';
+            cursor    = operand(word, 4, cursor);
+            cursor    = text(info.mode == AddressingMode::ABS ? "" : (info.mode == AddressingMode::ABSX ? ",X" : ",Y"), cursor);
+            break;
+        case AddressingMode::IND:
+            cursor    = text(" (", cursor);
+            cursor    = operand(word, 4, cursor);
+            *cursor++ = ')';
+            break;
+        case AddressingMode::INDX:
+            cursor = text(" (", cursor);
+            cursor = operand(low, 2, cursor);
+            cursor = text(",X)", cursor);
+            break;
+        case AddressingMode::INDY:
+            cursor = text(" (", cursor);
+            cursor = operand(low, 2, cursor);
+            cursor = text("),Y", cursor);
+            break;
+        case AddressingMode::REL:
+            *cursor++ = ' ';
+            cursor    = operand(static_cast<u16>(address + 2 + static_cast<s8>(low)), 4, cursor);
+            break;
+    }
+    return cursor;
+}
+
+u8 Disassembler::instruction(const u8* bytes, const u16 address, char* out) const {
+    const u8 length = Opcodes::length(bytes[0]);
+    *format(bytes, length, address, out) = '\0';
+    return length;
+}
+
+u8 Disassembler::instruction(const RAM& ram, const u16 address, char* out) const {
+    const u8 bytes[3] = {ram.peek(address), ram.peek(static_cast<u16>(address + 1)), ram.peek(static_cast<u16>(address + 2))};
+    return instruction(bytes, address, out);
+}
+
+size_t Disassembler::disassemble(const u8* data, const size_t size, const size_t available, const u16 base, char* out,
+                                 const size_t capacity, size_t& consumed) const {
+    char* cursor    = out;
+    char* const end = out + capacity;
+
+    size_t offset = 0;
+    while(offset < size) {
+        const u16 address                = static_cast<u16>(base + offset);
+        const u8 length                  = Opcodes::length(data[offset]);
+        const u8 fits                    = offset + length <= available ? length : 1;
+        const SymbolTable::Symbol* label = symbols ? symbols->exact(address) : nullptr;
+
+        size_t label_count = 0;
+        while(label && label + label_count < symbols->symbols + symbols->count && label[label_count].address == address) {
+            label_count++;
+        }
+
+        // Lines are only started when they fit along with their labels. Labels that would not fit even in an empty buffer are dropped.
+        const size_t room = static_cast<size_t>(end - cursor);
+        if(room < LINE_SIZE + label_count * LABEL_SIZE) {
+            if(cursor != out || room < LINE_SIZE) break;
+            label_count = (room - LINE_SIZE) / LABEL_SIZE;
+        }
+
+        for(size_t i = 0; i < label_count; i++) {
+            cursor = name(label[i], cursor);
+            cursor = text(":\n", cursor);
+        }
+        cursor    = format(&data[offset], fits, address, cursor);
+        *cursor++ = '\n';
+        offset += fits;
+    }
+
+    consumed = offset;
+    return static_cast<size_t>(cursor - out);
+}
+
+size_t Disassembler::disassemble(const u8* data, const size_t size, const u16 base, char* out, const size_t capacity, size_t& consumed) const {
+    return disassemble(data, size, size, base, out, capacity, consumed);
+}
+
+size_t Disassembler::disassemble(const RAM& ram, const u32 start, const u32 end, char* out, const size_t capacity, u32& next) const {
+    // Windows carry two bytes past their end, so instructions that straddle two windows are still decoded whole
+    u8 window[WINDOW + 2];
+    size_t used = 0;
+
+    const u32 last = end < 0x10000 ? end : 0x10000;
+
+    next = start;
+    while(next < last) {
+        const size_t size = last - next < WINDOW ? last - next : WINDOW;
+        const size_t tail = 0x10000 - next - size < 2 ? 0x10000 - next - size : 2; // The address space does not wrap
+        for(size_t i = 0; i < size + tail; i++) {
+            window[i] = ram.peek(static_cast<u16>(next + i));
+        }
+
+        size_t consumed;
+        used += disassemble(window, size, size + tail, static_cast<u16>(next), out + used, capacity - used, consumed);
+        next += static_cast<u32>(consumed);
+        if(consumed < size) break; // Out of space
+    }
+
+    return used;
+}
\ No newline at end of file
@@ -0,0 +1,27 @@
+#pragma once
+#include "cpu.h"
+#include "ram.h"
+#include "types.h"
+
+// Sprite DMA: a write of page number XX to $4014 copies $XX00-$XXFF into OAM while the CPU is halted for 513 cycles, plus one more
+// when the transfer starts on an odd cycle to realign with the read/write cycle pairs.
+struct DMA {
+    static constexpr u16 OAM_DMA       = 0x4014;
+    static constexpr size_t OAM_SIZE   = 256;
+    static constexpr u64 OAM_DMA_STALL = 513;
+
+    u8 oam[OAM_SIZE];
+
+    void oam_transfer(CPU& cpu, RAM& ram, const u8 page);
+};
+
+void DMA::oam_transfer(CPU& cpu, RAM& ram, const u8 page) {
+    const u64 stall   = OAM_DMA_STALL + (cpu.cycles & 1);
+    const u16 address = static_cast<u16>(page << RAM::PAGE_SHIFT);
+
+    ram.dump_block(address, oam, OAM_SIZE);
+    if(cpu.cdl) {
+        cpu.cdl->log_data(address, OAM_SIZE);
+    }
+    cpu.cycles += stall;
+}
\ No newline at end of file
@@ -95,7 +95,13 @@ constexpr u8
     JMP_ABS = 0x4C,
     JMP_IND = 0x6C;
 
+bool crosses_page(const u16 base, const u16 address) {
+    return (base & 0xFF00) != (address & 0xFF00);
+}
+
 void _unsupported(CPU& cpu, RAM& ram) {
+    cpu.cycles += 2; // Treated as a two cycle NOP until the opcode is implemented
+
     if(cpu.debug) {
         const u16 unsupported_index = cpu.pc;
         printf("Unsupported instruction: 0x%2.2x at 0x%4.4x\n", ram.read(unsupported_index), unsupported_index);
@@ -103,6 +109,8 @@ void _unsupported(CPU& cpu, RAM& ram) {
 }
 
 void _nop(CPU& cpu, RAM& ram) {
+    cpu.cycles += 2;
+
     CPU::DebugData data;
     data.instruction = "NOP";
 
@@ -123,6 +131,7 @@ void _adc_abs(CPU& cpu, RAM& ram) {
     cpu.set_status(CPU::NEGATIVE_FLAG, result & 0x0080);
 
     cpu.a = result & 0x00FF;
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "ADC_ABS";
@@ -133,13 +142,15 @@ void _adc_abs(CPU& cpu, RAM& ram) {
 }
 
 void _and_imm(CPU& cpu, RAM& ram) {
-    u8 value = cpu.next_byte(ram);
+    u16 address = cpu.pc;
+    u8 value    = cpu.next_byte(ram);
     cpu.a &= value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "AND_IMM";
-    data.address     = ram.most_recent_read;
+    data.address     = address;
     data.value       = value;
 
     cpu.debug_print_instruction(data);
@@ -150,6 +161,7 @@ void _and_zp(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.a &= value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 3;
 
     CPU::DebugData data;
     data.instruction = "AND_ZP";
@@ -164,6 +176,7 @@ void _and_zpx(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.a &= value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "AND_ZPX";
@@ -178,6 +191,7 @@ void _and_abs(CPU& cpu, RAM& ram) {
     u8 value    = cpu.read_byte(ram, address);
     cpu.a &= value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "AND_ABS";
@@ -188,10 +202,12 @@ void _and_abs(CPU& cpu, RAM& ram) {
 }
 
 void _and_absx(CPU& cpu, RAM& ram) {
-    u16 address = cpu.next_word(ram) + cpu.x;
+    u16 base    = cpu.next_word(ram);
+    u16 address = base + cpu.x;
     u8 value    = cpu.read_byte(ram, address);
     cpu.a &= value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4 + crosses_page(base, address);
 
     CPU::DebugData data;
     data.instruction = "AND_ABSX";
@@ -202,10 +218,12 @@ void _and_absx(CPU& cpu, RAM& ram) {
 }
 
 void _and_absy(CPU& cpu, RAM& ram) {
-    u16 address = cpu.next_word(ram) + cpu.y;
+    u16 base    = cpu.next_word(ram);
+    u16 address = base + cpu.y;
     u8 value    = cpu.read_byte(ram, address);
     cpu.a &= value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4 + crosses_page(base, address);
 
     CPU::DebugData data;
     data.instruction = "AND_ABSY";
@@ -219,6 +237,7 @@ void _lda_imm(CPU& cpu, RAM& ram) {
     u8 value = cpu.next_byte(ram);
     cpu.a    = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "LDA_IMM";
@@ -232,6 +251,7 @@ void _lda_zp(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.a      = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 3;
 
     CPU::DebugData data;
     data.instruction = "LDA_ZP";
@@ -246,6 +266,7 @@ void _lda_zpx(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.a      = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "LDA_ZPX";
@@ -260,6 +281,7 @@ void _lda_abs(CPU& cpu, RAM& ram) {
     u8 value    = cpu.read_byte(ram, address);
     cpu.a       = value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "LDA_ABS";
@@ -270,10 +292,12 @@ void _lda_abs(CPU& cpu, RAM& ram) {
 }
 
 void _lda_absx(CPU& cpu, RAM& ram) {
-    u16 address = cpu.next_word(ram) + cpu.x;
+    u16 base    = cpu.next_word(ram);
+    u16 address = base + cpu.x;
     u8 value    = cpu.read_byte(ram, address);
     cpu.a       = value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4 + crosses_page(base, address);
 
     CPU::DebugData data;
     data.instruction = "LDA_ABSX";
@@ -284,10 +308,12 @@ void _lda_absx(CPU& cpu, RAM& ram) {
 }
 
 void _lda_absy(CPU& cpu, RAM& ram) {
-    u16 address = cpu.next_word(ram) + cpu.y;
+    u16 base    = cpu.next_word(ram);
+    u16 address = base + cpu.y;
     u8 value    = cpu.read_byte(ram, address);
     cpu.a       = value;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4 + crosses_page(base, address);
 
     CPU::DebugData data;
     data.instruction = "LDA_ABSY";
@@ -301,6 +327,7 @@ void _ldx_imm(CPU& cpu, RAM& ram) {
     u8 value = cpu.next_byte(ram);
     cpu.x    = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "LDX_IMM";
@@ -314,6 +341,7 @@ void _ldx_zp(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.x      = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 3;
 
     CPU::DebugData data;
     data.instruction = "LDX_ZP";
@@ -328,6 +356,7 @@ void _ldx_zpy(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.x      = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "LDX_ZPY";
@@ -342,6 +371,7 @@ void _ldx_abs(CPU& cpu, RAM& ram) {
     u8 value    = cpu.read_byte(ram, address);
     cpu.x       = value;
     cpu.update_status(cpu.x, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "LDX_ABS";
@@ -352,10 +382,12 @@ void _ldx_abs(CPU& cpu, RAM& ram) {
 }
 
 void _ldx_absy(CPU& cpu, RAM& ram) {
-    u16 address = cpu.next_word(ram) + cpu.y;
+    u16 base    = cpu.next_word(ram);
+    u16 address = base + cpu.y;
     u8 value    = cpu.read_byte(ram, address);
     cpu.x       = value;
     cpu.update_status(cpu.x, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4 + crosses_page(base, address);
 
     CPU::DebugData data;
     data.instruction = "LDX_ABSY";
@@ -369,6 +401,7 @@ void _ldy_imm(CPU& cpu, RAM& ram) {
     u8 value = cpu.next_byte(ram);
     cpu.y    = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "LDY_IMM";
@@ -382,6 +415,7 @@ void _ldy_zp(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.y      = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 3;
 
     CPU::DebugData data;
     data.instruction = "LDY_ZP";
@@ -396,6 +430,7 @@ void _ldy_zpx(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.y      = value;
     cpu.update_status(value, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "LDY_ZPX";
@@ -410,6 +445,7 @@ void _ldy_abs(CPU& cpu, RAM& ram) {
     u8 value    = cpu.read_byte(ram, address);
     cpu.y       = value;
     cpu.update_status(cpu.y, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "LDY_ABS";
@@ -420,14 +456,16 @@ void _ldy_abs(CPU& cpu, RAM& ram) {
 }
 
 void _ldy_absx(CPU& cpu, RAM& ram) {
-    u16 address = cpu.next_word(ram) + cpu.x;
+    u16 base    = cpu.next_word(ram);
+    u16 address = base + cpu.x;
     u8 value    = cpu.read_byte(ram, address);
     cpu.y       = value;
     cpu.update_status(cpu.y, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 4 + crosses_page(base, address);
 
     CPU::DebugData data;
     data.instruction = "LDY_ABSX";
-    data.address     = ram.most_recent_read;
+    data.address     = address;
     data.value       = value;
 
     cpu.debug_print_instruction(data);
@@ -435,6 +473,7 @@ void _ldy_absx(CPU& cpu, RAM& ram) {
 
 void _sec(CPU& cpu, RAM& ram) {
     cpu.set_status(CPU::CARRY_FLAG, true);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "SEC";
@@ -444,6 +483,7 @@ void _sec(CPU& cpu, RAM& ram) {
 
 void _sed(CPU& cpu, RAM& ram) {
     cpu.set_status(CPU::DECIMAL_FLAG, true);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "SED";
@@ -453,6 +493,7 @@ void _sed(CPU& cpu, RAM& ram) {
 
 void _sei(CPU& cpu, RAM& ram) {
     cpu.set_status(CPU::INTERRUPT_FLAG, true);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "SEI";
@@ -462,6 +503,7 @@ void _sei(CPU& cpu, RAM& ram) {
 
 void _clc(CPU& cpu, RAM& ram) {
     cpu.set_status(CPU::CARRY_FLAG, false);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "CLC";
@@ -471,6 +513,7 @@ void _clc(CPU& cpu, RAM& ram) {
 
 void _cld(CPU& cpu, RAM& ram) {
     cpu.set_status(CPU::DECIMAL_FLAG, false);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "CLD";
@@ -480,6 +523,7 @@ void _cld(CPU& cpu, RAM& ram) {
 
 void _cli(CPU& cpu, RAM& ram) {
     cpu.set_status(CPU::INTERRUPT_FLAG, false);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "CLI";
@@ -489,6 +533,7 @@ void _cli(CPU& cpu, RAM& ram) {
 
 void _clv(CPU& cpu, RAM& ram) {
     cpu.set_status(CPU::OVERFLOW_FLAG, false);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "CLV";
@@ -499,6 +544,7 @@ void _clv(CPU& cpu, RAM& ram) {
 void _sta_zp(CPU& cpu, RAM& ram) {
     u8 address = cpu.next_byte(ram);
     cpu.write_byte(ram, address, cpu.a);
+    cpu.cycles += 3;
 
     CPU::DebugData data;
     data.instruction = "STA_ZP";
@@ -511,6 +557,7 @@ void _sta_zp(CPU& cpu, RAM& ram) {
 void _sta_zpx(CPU& cpu, RAM& ram) {
     u8 address = cpu.next_byte(ram) + cpu.x;
     cpu.write_byte(ram, address, cpu.a);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "STA_ZPX";
@@ -523,6 +570,7 @@ void _sta_zpx(CPU& cpu, RAM& ram) {
 void _sta_abs(CPU& cpu, RAM& ram) {
     u16 address = cpu.next_word(ram);
     cpu.write_byte(ram, address, cpu.a);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "STA_ABS";
@@ -535,6 +583,7 @@ void _sta_abs(CPU& cpu, RAM& ram) {
 void _stx_zp(CPU& cpu, RAM& ram) {
     u8 address = cpu.next_byte(ram);
     cpu.write_byte(ram, address, cpu.x);
+    cpu.cycles += 3;
 
     CPU::DebugData data;
     data.instruction = "STX_ZP";
@@ -547,6 +596,7 @@ void _stx_zp(CPU& cpu, RAM& ram) {
 void _stx_zpy(CPU& cpu, RAM& ram) {
     u8 address = cpu.next_byte(ram) + cpu.y;
     cpu.write_byte(ram, address, cpu.x);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "STX_ZPY";
@@ -559,6 +609,7 @@ void _stx_zpy(CPU& cpu, RAM& ram) {
 void _stx_abs(CPU& cpu, RAM& ram) {
     u16 address = cpu.next_word(ram);
     cpu.write_byte(ram, address, cpu.x);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "STX_ABS";
@@ -571,6 +622,7 @@ void _stx_abs(CPU& cpu, RAM& ram) {
 void _sty_zp(CPU& cpu, RAM& ram) {
     u8 address = cpu.next_byte(ram);
     cpu.write_byte(ram, address, cpu.y);
+    cpu.cycles += 3;
 
     CPU::DebugData data;
     data.instruction = "STY_ZP";
@@ -583,6 +635,7 @@ void _sty_zp(CPU& cpu, RAM& ram) {
 void _sty_zpx(CPU& cpu, RAM& ram) {
     u8 address = cpu.next_byte(ram) + cpu.x;
     cpu.write_byte(ram, address, cpu.y);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "STY_ZPX";
@@ -595,6 +648,7 @@ void _sty_zpx(CPU& cpu, RAM& ram) {
 void _sty_abs(CPU& cpu, RAM& ram) {
     u16 address = cpu.next_word(ram);
     cpu.write_byte(ram, address, cpu.y);
+    cpu.cycles += 4;
 
     CPU::DebugData data;
     data.instruction = "STY_ABS";
@@ -607,6 +661,7 @@ void _sty_abs(CPU& cpu, RAM& ram) {
 void _tax(CPU& cpu, RAM& ram) {
     cpu.x = cpu.a;
     cpu.update_status(cpu.x, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "TAX";
@@ -618,6 +673,7 @@ void _tax(CPU& cpu, RAM& ram) {
 void _tay(CPU& cpu, RAM& ram) {
     cpu.y = cpu.a;
     cpu.update_status(cpu.y, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "TAY";
@@ -629,6 +685,7 @@ void _tay(CPU& cpu, RAM& ram) {
 void _tsx(CPU& cpu, RAM& ram) {
     cpu.x = cpu.sp;
     cpu.update_status(cpu.x, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "TSX";
@@ -640,6 +697,7 @@ void _tsx(CPU& cpu, RAM& ram) {
 void _txa(CPU& cpu, RAM& ram) {
     cpu.a = cpu.x;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "TXA";
@@ -650,6 +708,7 @@ void _txa(CPU& cpu, RAM& ram) {
 
 void _txs(CPU& cpu, RAM& ram) {
     cpu.sp = cpu.x;
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "TXS";
@@ -661,6 +720,7 @@ void _txs(CPU& cpu, RAM& ram) {
 void _tya(CPU& cpu, RAM& ram) {
     cpu.a = cpu.y;
     cpu.update_status(cpu.a, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "TYA";
@@ -674,6 +734,7 @@ void _dec_zp(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.write_byte(ram, address, value - 1);
     cpu.update_status(value - 1, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 5;
 
     CPU::DebugData data;
     data.instruction = "DEC_ZP";
@@ -688,6 +749,7 @@ void _dec_zpx(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.write_byte(ram, address, value - 1);
     cpu.update_status(value - 1, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 6;
 
     CPU::DebugData data;
     data.instruction = "DEC_ZPX";
@@ -702,6 +764,7 @@ void _dec_abs(CPU& cpu, RAM& ram) {
     u8 value    = cpu.read_byte(ram, address);
     cpu.write_byte(ram, address, value - 1);
     cpu.update_status(value - 1, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 6;
 
     CPU::DebugData data;
     data.instruction = "DEC_ABS";
@@ -716,6 +779,7 @@ void _dec_absx(CPU& cpu, RAM& ram) {
     u8 value    = cpu.read_byte(ram, address);
     cpu.write_byte(ram, address, value - 1);
     cpu.update_status(value - 1, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 7;
 
     CPU::DebugData data;
     data.instruction = "DEC_ABSX";
@@ -728,6 +792,7 @@ void _dec_absx(CPU& cpu, RAM& ram) {
 void _dex(CPU& cpu, RAM& ram) {
     cpu.x--;
     cpu.update_status(cpu.x, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "DEX";
@@ -738,6 +803,7 @@ void _dex(CPU& cpu, RAM& ram) {
 void _dey(CPU& cpu, RAM& ram) {
     cpu.y--;
     cpu.update_status(cpu.y, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "DEY";
@@ -750,6 +816,7 @@ void _inc_zp(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.write_byte(ram, address, value + 1);
     cpu.update_status(value + 1, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 5;
 
     CPU::DebugData data;
     data.instruction = "INC_ZP";
@@ -764,6 +831,7 @@ void _inc_zpx(CPU& cpu, RAM& ram) {
     u8 value   = cpu.read_byte(ram, address);
     cpu.write_byte(ram, address, value + 1);
     cpu.update_status(value + 1, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 6;
 
     CPU::DebugData data;
     data.instruction = "INC_ZPX";
@@ -778,6 +846,7 @@ void _inc_abs(CPU& cpu, RAM& ram) {
     u8 value    = cpu.read_byte(ram, address);
     cpu.write_byte(ram, address, value + 1);
     cpu.update_status(value + 1, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 6;
 
     CPU::DebugData data;
     data.instruction = "INC_ABS";
@@ -792,6 +861,7 @@ void _inc_absx(CPU& cpu, RAM& ram) {
     u8 value    = cpu.read_byte(ram, address);
     cpu.write_byte(ram, address, value + 1);
     cpu.update_status(value + 1, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 7;
 
     CPU::DebugData data;
     data.instruction = "INC_ABSX";
@@ -804,6 +874,7 @@ void _inc_absx(CPU& cpu, RAM& ram) {
 void _inx(CPU& cpu, RAM& ram) {
     cpu.x++;
     cpu.update_status(cpu.x, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "INX";
@@ -814,6 +885,7 @@ void _inx(CPU& cpu, RAM& ram) {
 void _iny(CPU& cpu, RAM& ram) {
     cpu.y++;
     cpu.update_status(cpu.y, CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG);
+    cpu.cycles += 2;
 
     CPU::DebugData data;
     data.instruction = "INY";
@@ -824,6 +896,7 @@ void _iny(CPU& cpu, RAM& ram) {
 void _jmp_abs(CPU& cpu, RAM& ram) {
     u16 address = cpu.next_word(ram);
     cpu.pc      = address;
+    cpu.cycles += 3;
 
     CPU::DebugData data;
     data.instruction = "JMP_ABS";
@@ -837,6 +910,7 @@ void _jmp_ind(CPU& cpu, RAM& ram) {
     cpu.pc               = address;
     u16 indirect_address = cpu.next_word(ram);
     cpu.pc               = indirect_address;
+    cpu.cycles += 5;
 
     CPU::DebugData data;
     data.instruction = "JMP_IND";
@@ -845,69 +919,81 @@ void _jmp_ind(CPU& cpu, RAM& ram) {
     cpu.debug_print_instruction(data);
 }
 
-void load_instructions(CPU& cpu) {
+// The handlers are the same for every CPU, so the table is built once and load_instructions only points a CPU at it
+struct InstructionTable {
+    CPU::Instruction handlers[CPU::MAX_INSTRUCTIONS];
+
+    InstructionTable();
+};
+
+InstructionTable::InstructionTable() {
     for(size_t i = 0; i < CPU::MAX_INSTRUCTIONS; i++) {
-        cpu.instructions[i] = _unsupported;
+        handlers[i] = _unsupported;
     }
 
-    cpu.instructions[NOP]      = _nop;
-    cpu.instructions[ADC_ABS]  = _adc_abs;
-    cpu.instructions[AND_IMM]  = _and_imm;
-    cpu.instructions[AND_ZP]   = _and_zp;
-    cpu.instructions[AND_ZPX]  = _and_zpx;
-    cpu.instructions[AND_ABS]  = _and_abs;
-    cpu.instructions[AND_ABSX] = _and_absx;
-    cpu.instructions[AND_ABSY] = _and_absy;
-    cpu.instructions[LDA_IMM]  = _lda_imm;
-    cpu.instructions[LDA_ZP]   = _lda_zp;
-    cpu.instructions[LDA_ZPX]  = _lda_zpx;
-    cpu.instructions[LDA_ABS]  = _lda_abs;
-    cpu.instructions[LDA_ABSX] = _lda_absx;
-    cpu.instructions[LDA_ABSY] = _lda_absy;
-    cpu.instructions[LDX_IMM]  = _ldx_imm;
-    cpu.instructions[LDX_ZP]   = _ldx_zp;
-    cpu.instructions[LDX_ZPY]  = _ldx_zpy;
-    cpu.instructions[LDX_ABS]  = _ldx_abs;
-    cpu.instructions[LDX_ABSY] = _ldx_absy;
-    cpu.instructions[LDY_IMM]  = _ldy_imm;
-    cpu.instructions[LDY_ZP]   = _ldy_zp;
-    cpu.instructions[LDY_ZPX]  = _ldy_zpx;
-    cpu.instructions[LDY_ABS]  = _ldy_abs;
-    cpu.instructions[LDY_ABSX] = _ldy_absx;
-    cpu.instructions[SEC]      = _sec;
-    cpu.instructions[SED]      = _sed;
-    cpu.instructions[SEI]      = _sei;
-    cpu.instructions[CLC]      = _clc;
-    cpu.instructions[CLD]      = _cld;
-    cpu.instructions[CLI]      = _cli;
-    cpu.instructions[CLV]      = _clv;
-    cpu.instructions[STA_ZP]   = _sta_zp;
-    cpu.instructions[STA_ZPX]  = _sta_zpx;
-    cpu.instructions[STA_ABS]  = _sta_abs;
-    cpu.instructions[STX_ZP]   = _stx_zp;
-    cpu.instructions[STX_ZPY]  = _stx_zpy;
-    cpu.instructions[STX_ABS]  = _stx_abs;
-    cpu.instructions[STY_ZP]   = _sty_zp;
-    cpu.instructions[STY_ZPX]  = _sty_zpx;
-    cpu.instructions[STY_ABS]  = _sty_abs;
-    cpu.instructions[TAX]      = _tax;
-    cpu.instructions[TAY]      = _tay;
-    cpu.instructions[TSX]      = _tsx;
-    cpu.instructions[TXA]      = _txa;
-    cpu.instructions[TXS]      = _txs;
-    cpu.instructions[TYA]      = _tya;
-    cpu.instructions[DEC_ZP]   = _dec_zp;
-    cpu.instructions[DEC_ZPX]  = _dec_zpx;
-    cpu.instructions[DEC_ABS]  = _dec_abs;
-    cpu.instructions[DEC_ABSX] = _dec_absx;
-    cpu.instructions[DEX]      = _dex;
-    cpu.instructions[DEY]      = _dey;
-    cpu.instructions[INC_ZP]   = _inc_zp;
-    cpu.instructions[INC_ZPX]  = _inc_zpx;
-    cpu.instructions[INC_ABS]  = _inc_abs;
-    cpu.instructions[INC_ABSX] = _inc_absx;
-    cpu.instructions[INX]      = _inx;
-    cpu.instructions[INY]      = _iny;
-    cpu.instructions[JMP_ABS]  = _jmp_abs;
-    cpu.instructions[JMP_IND]  = _jmp_ind;
+    handlers[NOP]      = _nop;
+    handlers[ADC_ABS]  = _adc_abs;
+    handlers[AND_IMM]  = _and_imm;
+    handlers[AND_ZP]   = _and_zp;
+    handlers[AND_ZPX]  = _and_zpx;
+    handlers[AND_ABS]  = _and_abs;
+    handlers[AND_ABSX] = _and_absx;
+    handlers[AND_ABSY] = _and_absy;
+    handlers[LDA_IMM]  = _lda_imm;
+    handlers[LDA_ZP]   = _lda_zp;
+    handlers[LDA_ZPX]  = _lda_zpx;
+    handlers[LDA_ABS]  = _lda_abs;
+    handlers[LDA_ABSX] = _lda_absx;
+    handlers[LDA_ABSY] = _lda_absy;
+    handlers[LDX_IMM]  = _ldx_imm;
+    handlers[LDX_ZP]   = _ldx_zp;
+    handlers[LDX_ZPY]  = _ldx_zpy;
+    handlers[LDX_ABS]  = _ldx_abs;
+    handlers[LDX_ABSY] = _ldx_absy;
+    handlers[LDY_IMM]  = _ldy_imm;
+    handlers[LDY_ZP]   = _ldy_zp;
+    handlers[LDY_ZPX]  = _ldy_zpx;
+    handlers[LDY_ABS]  = _ldy_abs;
+    handlers[LDY_ABSX] = _ldy_absx;
+    handlers[SEC]      = _sec;
+    handlers[SED]      = _sed;
+    handlers[SEI]      = _sei;
+    handlers[CLC]      = _clc;
+    handlers[CLD]      = _cld;
+    handlers[CLI]      = _cli;
+    handlers[CLV]      = _clv;
+    handlers[STA_ZP]   = _sta_zp;
+    handlers[STA_ZPX]  = _sta_zpx;
+    handlers[STA_ABS]  = _sta_abs;
+    handlers[STX_ZP]   = _stx_zp;
+    handlers[STX_ZPY]  = _stx_zpy;
+    handlers[STX_ABS]  = _stx_abs;
+    handlers[STY_ZP]   = _sty_zp;
+    handlers[STY_ZPX]  = _sty_zpx;
+    handlers[STY_ABS]  = _sty_abs;
+    handlers[TAX]      = _tax;
+    handlers[TAY]      = _tay;
+    handlers[TSX]      = _tsx;
+    handlers[TXA]      = _txa;
+    handlers[TXS]      = _txs;
+    handlers[TYA]      = _tya;
+    handlers[DEC_ZP]   = _dec_zp;
+    handlers[DEC_ZPX]  = _dec_zpx;
+    handlers[DEC_ABS]  = _dec_abs;
+    handlers[DEC_ABSX] = _dec_absx;
+    handlers[DEX]      = _dex;
+    handlers[DEY]      = _dey;
+    handlers[INC_ZP]   = _inc_zp;
+    handlers[INC_ZPX]  = _inc_zpx;
+    handlers[INC_ABS]  = _inc_abs;
+    handlers[INC_ABSX] = _inc_absx;
+    handlers[INX]      = _inx;
+    handlers[INY]      = _iny;
+    handlers[JMP_ABS]  = _jmp_abs;
+    handlers[JMP_IND]  = _jmp_ind;
+}
+
+void load_instructions(CPU& cpu) {
+    static const InstructionTable table;
+    cpu.instructions = table.handlers;
 }
\ No newline at end of file
@@ -0,0 +1,406 @@
+#pragma once
+#include "cpu.h"
+#include "instructions.h"
+#include "ram.h"
+#include "types.h"
+
+// Runs up to LANES CPUs over the same code with their registers in structure-of-arrays form. Each step picks the lanes that sit at
+// the same PC on identical instruction bytes and executes that instruction for all of them at once: register, immediate, flag and
+// jump instructions are plain loops over the lane arrays that the compiler turns into SIMD blends, zero page accesses gather from each
+// lane's RAM, and everything else falls back to the scalar handler lane by lane. Lanes at other PCs are masked off and picked up by a
+// later step, lowest PC first, which lets lanes that took different paths fall back into step when the paths meet again.
+//
+// Instruction bytes are compared between lanes unless the lanes share the code page itself, as they do when attached to the same
+// MemoryImage; while every lane is on one shared page and no scalar instruction has run, steps skip the comparison entirely.
+struct Lockstep {
+    static constexpr size_t LANES = 32;
+
+    alignas(64) u16 pc[LANES];
+    alignas(64) u8 a[LANES];
+    alignas(64) u8 x[LANES];
+    alignas(64) u8 y[LANES];
+    alignas(64) u8 sp[LANES];
+    alignas(64) u8 s[LANES];
+    alignas(64) u64 cycles[LANES];
+    RAM* memory[LANES];
+    size_t lane_count = 0;
+    u64 vector_steps  = 0; // Instructions executed across lanes
+    u64 scalar_steps  = 0; // Instructions executed through the scalar handlers, counted per lane
+
+    void load(const size_t lane, const CPU& cpu, RAM& ram);
+    void store(const size_t lane, CPU& cpu) const;
+
+    // Every lane executes instruction_count instructions
+    void execute_instructions(const size_t instruction_count);
+
+private:
+    enum class LaneOp : u8 {
+        SCALAR,
+        NOP,
+        LOAD_IMM,
+        AND_IMM,
+        TRANSFER,
+        INCREMENT,
+        SET_FLAG,
+        CLEAR_FLAG,
+        JMP_ABS,
+        LOAD_ZP,
+        STORE_ZP,
+        MODIFY_ZP,
+    };
+
+    enum Register : u8 {
+        REG_A,
+        REG_X,
+        REG_Y,
+        REG_SP,
+    };
+
+    struct Decoded {
+        LaneOp op;
+        u8 length;
+        u8 cycles;
+        u8 target;  // Register written, or the flag bits for SET_FLAG/CLEAR_FLAG
+        u8 source;  // Register read by TRANSFER and STORE_ZP
+        u8 delta;   // Added by INCREMENT and MODIFY_ZP
+        bool flags; // Whether N and Z follow the result
+    };
+
+    struct LaneTable {
+        Decoded entries[CPU::MAX_INSTRUCTIONS];
+
+        LaneTable();
+        void set(const u8 opcode, const LaneOp op, const u8 length, const u8 cycles, const u8 target = 0, const u8 source = 0,
+                 const u8 delta = 0, const bool flags = true);
+    };
+
+    alignas(64) u8 active[LANES];
+    alignas(64) u32 remaining[LANES];
+    CPU scalar;
+    size_t leader;
+    size_t live;
+    bool converged;     // Every live lane was active in the last step and nothing since could have split them
+    s32 verified_page;  // Code page known to be shared by every live lane, or -1
+
+    // While converged, the PC, cycle and instruction counts every active lane shares are kept here and only written back to the lanes
+    // by settle(), so a step touches nothing but the registers it changes. Lanes can converge with different instruction counts left,
+    // so the group only runs until the lane with the fewest has finished.
+    u16 group_pc;
+    u32 group_steps;
+    u32 group_limit;
+    u64 group_cycles;
+
+    [[nodiscard]] size_t gather(const LaneTable& table, const Decoded*& decoded, u8 (&bytes)[3]);
+    void execute_lanes(const Decoded& decoded, const u8 operand_1, const u8 operand_2);
+    void execute_scalar(const size_t lane);
+    void settle();
+    [[nodiscard]] u8* lane_register(const u8 index);
+    void write_result(u8* to, const u8* from, const bool flags);
+};
+
+void Lockstep::load(const size_t lane, const CPU& cpu, RAM& ram) {
+    pc[lane]     = cpu.pc;
+    a[lane]      = cpu.a;
+    x[lane]      = cpu.x;
+    y[lane]      = cpu.y;
+    sp[lane]     = cpu.sp;
+    s[lane]      = cpu.s;
+    cycles[lane] = cpu.cycles;
+    memory[lane] = &ram;
+    lane_count   = lane + 1 > lane_count ? lane + 1 : lane_count;
+}
+
+void Lockstep::store(const size_t lane, CPU& cpu) const {
+    cpu.pc     = pc[lane];
+    cpu.a      = a[lane];
+    cpu.x      = x[lane];
+    cpu.y      = y[lane];
+    cpu.sp     = sp[lane];
+    cpu.s      = s[lane];
+    cpu.cycles = cycles[lane];
+}
+
+void Lockstep::execute_instructions(const size_t instruction_count) {
+    static const LaneTable table;
+
+    load_instructions(scalar);
+    scalar.debug = false;
+
+    for(size_t i = 0; i < LANES; i++) {
+        remaining[i] = i < lane_count ? static_cast<u32>(instruction_count) : 0;
+    }
+    converged     = false;
+    verified_page = -1;
+
+    const Decoded* decoded;
+    u8 bytes[3];
+    while(gather(table, decoded, bytes)) {
+        if(decoded->op == LaneOp::SCALAR) {
+            settle();
+            for(size_t i = 0; i < lane_count; i++) {
+                if(active[i]) {
+                    execute_scalar(i);
+                }
+            }
+            for(size_t i = 0; i < LANES; i++) {
+                remaining[i] -= active[i] & 1;
+            }
+        } else {
+            execute_lanes(*decoded, bytes[1], bytes[2]);
+            vector_steps++;
+        }
+    }
+    settle();
+}
+
+size_t Lockstep::gather(const LaneTable& table, const Decoded*& decoded, u8 (&bytes)[3]) {
+    if(converged) {
+        // The mask from the last step still holds; only a page change needs the lanes checked again
+        const u16 address = group_pc;
+        const bool shared = static_cast<s32>(address >> RAM::PAGE_SHIFT) == verified_page && (address & RAM::PAGE_MASK) <= 0xFD;
+        if(shared && group_steps < group_limit) {
+            RAM& code = *memory[leader];
+            bytes[0]  = code.read(address);
+            decoded   = &table.entries[bytes[0]];
+            bytes[1]  = decoded->length > 1 ? code.read(static_cast<u16>(address + 1)) : 0x00;
+            bytes[2]  = decoded->length > 2 ? code.read(static_cast<u16>(address + 2)) : 0x00;
+            return live;
+        }
+
+        settle();
+    }
+
+    leader = LANES;
+    for(size_t i = 0; i < lane_count; i++) {
+        if(remaining[i] && (leader == LANES || pc[i] < pc[leader])) {
+            leader = i;
+        }
+    }
+    if(leader == LANES) return 0;
+
+    const u16 address   = pc[leader];
+    RAM& code           = *memory[leader];
+    bytes[0]            = code.read(address);
+    decoded             = &table.entries[bytes[0]];
+    const u8 length     = decoded->length;
+    bytes[1]            = length > 1 ? code.read(static_cast<u16>(address + 1)) : 0x00;
+    bytes[2]            = length > 2 ? code.read(static_cast<u16>(address + 2)) : 0x00;
+    const u8 page_index = address >> RAM::PAGE_SHIFT;
+    const u8* page      = (address & RAM::PAGE_MASK) <= 0xFD ? code.page_data(page_index) : nullptr;
+
+    size_t count    = 0;
+    size_t waiting  = 0;
+    u32 fewest      = remaining[leader];
+    bool all_shared = page != nullptr;
+    for(size_t i = 0; i < lane_count; i++) {
+        bool match = remaining[i] && pc[i] == address;
+        if(match && i != leader && !(page && memory[i]->page_data(page_index) == page)) {
+            RAM& lane_code = *memory[i];
+            match          = lane_code.read(address) == bytes[0];
+            match          = match && (length < 2 || lane_code.read(static_cast<u16>(address + 1)) == bytes[1]);
+            match          = match && (length < 3 || lane_code.read(static_cast<u16>(address + 2)) == bytes[2]);
+            all_shared     = false;
+        }
+        active[i] = match ? 0xFF : 0x00;
+        fewest    = match && remaining[i] < fewest ? remaining[i] : fewest;
+        count += match;
+        waiting += remaining[i] != 0;
+    }
+    for(size_t i = lane_count; i < LANES; i++) {
+        active[i] = 0x00;
+    }
+
+    live          = count;
+    converged     = count == waiting;
+    verified_page = converged && all_shared ? page_index : -1;
+    group_pc      = address;
+    group_steps   = 0;
+    group_limit   = fewest;
+    group_cycles  = 0;
+
+    return count;
+}
+
+void Lockstep::execute_lanes(const Decoded& decoded, const u8 operand_1, const u8 operand_2) {
+    u8* target      = lane_register(decoded.target);
+    const u16 start = converged ? group_pc : 0;
+    u16 next        = start + decoded.length;
+
+    switch(decoded.op) {
+        case LaneOp::LOAD_IMM: {
+            u8 values[LANES];
+            for(size_t i = 0; i < LANES; i++) {
+                values[i] = operand_1;
+            }
+            write_result(target, values, decoded.flags);
+            break;
+        }
+        case LaneOp::AND_IMM: {
+            u8 values[LANES];
+            for(size_t i = 0; i < LANES; i++) {
+                values[i] = a[i] & operand_1;
+            }
+            write_result(a, values, decoded.flags);
+            break;
+        }
+        case LaneOp::TRANSFER:
+            write_result(target, lane_register(decoded.source), decoded.flags);
+            break;
+        case LaneOp::INCREMENT: {
+            u8 values[LANES];
+            for(size_t i = 0; i < LANES; i++) {
+                values[i] = target[i] + decoded.delta;
+            }
+            write_result(target, values, decoded.flags);
+            break;
+        }
+        case LaneOp::SET_FLAG:
+            for(size_t i = 0; i < LANES; i++) {
+                s[i] |= decoded.target & active[i];
+            }
+            break;
+        case LaneOp::CLEAR_FLAG:
+            for(size_t i = 0; i < LANES; i++) {
+                s[i] &= ~(decoded.target & active[i]);
+            }
+            break;
+        case LaneOp::JMP_ABS:
+            next = operand_1 | (operand_2 << 8);
+            break;
+        case LaneOp::LOAD_ZP: {
+            u8 values[LANES] = {};
+            for(size_t i = 0; i < lane_count; i++) {
+                values[i] = active[i] ? memory[i]->read(operand_1) : 0x00;
+            }
+            write_result(target, values, decoded.flags);
+            break;
+        }
+        case LaneOp::STORE_ZP: {
+            const u8* source = lane_register(decoded.source);
+            for(size_t i = 0; i < lane_count; i++) {
+                if(active[i]) {
+                    memory[i]->write(operand_1, source[i]);
+                }
+            }
+            verified_page = verified_page == 0 ? -1 : verified_page;
+            break;
+        }
+        case LaneOp::MODIFY_ZP: {
+            u8 values[LANES] = {};
+            for(size_t i = 0; i < lane_count; i++) {
+                if(active[i]) {
+                    values[i] = memory[i]->read(operand_1) + decoded.delta;
+                    memory[i]->write(operand_1, values[i]);
+                }
+            }
+            u8 results[LANES] = {};
+            write_result(results, values, true);
+            verified_page = verified_page == 0 ? -1 : verified_page;
+            break;
+        }
+        case LaneOp::NOP:
+        case LaneOp::SCALAR:
+            break;
+    }
+
+    if(converged) {
+        group_pc = next;
+        group_steps++;
+        group_cycles += decoded.cycles;
+        return;
+    }
+
+    for(size_t i = 0; i < LANES; i++) {
+        if(decoded.op == LaneOp::JMP_ABS) {
+            pc[i] = active[i] ? next : pc[i];
+        } else {
+            pc[i] += decoded.length & active[i];
+        }
+        cycles[i] += active[i] ? decoded.cycles : 0;
+        remaining[i] -= active[i] & 1;
+    }
+}
+
+void Lockstep::settle() {
+    if(!converged) return;
+
+    for(size_t i = 0; i < LANES; i++) {
+        pc[i] = active[i] ? group_pc : pc[i];
+        cycles[i] += active[i] ? group_cycles : 0;
+        remaining[i] -= active[i] ? group_steps : 0;
+    }
+    converged = false;
+}
+
+void Lockstep::execute_scalar(const size_t lane) {
+    store(lane, scalar);
+    scalar.execute(*memory[lane]);
+    load(lane, scalar, *memory[lane]);
+    scalar_steps++;
+}
+
+u8* Lockstep::lane_register(const u8 index) {
+    switch(index) {
+        case REG_X: return x;
+        case REG_Y: return y;
+        case REG_SP: return sp;
+        default: return a;
+    }
+}
+
+void Lockstep::write_result(u8* to, const u8* from, const bool flags) {
+    static constexpr u8 ZN = CPU::ZERO_FLAG | CPU::NEGATIVE_FLAG;
+
+    for(size_t i = 0; i < LANES; i++) {
+        const u8 value = from[i];
+        to[i]          = (value & active[i]) | (to[i] & ~active[i]);
+
+        if(flags) {
+            const u8 status = (value == 0 ? CPU::ZERO_FLAG : 0) | (value & CPU::NEGATIVE_FLAG);
+            s[i]            = (((s[i] & ~ZN) | status) & active[i]) | (s[i] & ~active[i]);
+        }
+    }
+}
+
+void Lockstep::LaneTable::set(const u8 opcode, const LaneOp op, const u8 length, const u8 cycles, const u8 target, const u8 source,
+                              const u8 delta, const bool flags) {
+    entries[opcode] = {op, length, cycles, target, source, delta, flags};
+}
+
+Lockstep::LaneTable::LaneTable() {
+    for(size_t i = 0; i < CPU::MAX_INSTRUCTIONS; i++) {
+        set(static_cast<u8>(i), LaneOp::SCALAR, 1, 0);
+    }
+
+    set(NOP, LaneOp::NOP, 1, 2);
+    set(LDA_IMM, LaneOp::LOAD_IMM, 2, 2, REG_A);
+    set(LDX_IMM, LaneOp::LOAD_IMM, 2, 2, REG_X);
+    set(LDY_IMM, LaneOp::LOAD_IMM, 2, 2, REG_Y);
+    set(AND_IMM, LaneOp::AND_IMM, 2, 2, REG_A);
+    set(TAX, LaneOp::TRANSFER, 1, 2, REG_X, REG_A);
+    set(TAY, LaneOp::TRANSFER, 1, 2, REG_Y, REG_A);
+    set(TXA, LaneOp::TRANSFER, 1, 2, REG_A, REG_X);
+    set(TYA, LaneOp::TRANSFER, 1, 2, REG_A, REG_Y);
+    set(TSX, LaneOp::TRANSFER, 1, 2, REG_X, REG_SP);
+    set(TXS, LaneOp::TRANSFER, 1, 2, REG_SP, REG_X, 0, false);
+    set(INX, LaneOp::INCREMENT, 1, 2, REG_X, 0, 0x01);
+    set(INY, LaneOp::INCREMENT, 1, 2, REG_Y, 0, 0x01);
+    set(DEX, LaneOp::INCREMENT, 1, 2, REG_X, 0, 0xFF);
+    set(DEY, LaneOp::INCREMENT, 1, 2, REG_Y, 0, 0xFF);
+    set(SEC, LaneOp::SET_FLAG, 1, 2, CPU::CARRY_FLAG);
+    set(SED, LaneOp::SET_FLAG, 1, 2, CPU::DECIMAL_FLAG);
+    set(SEI, LaneOp::SET_FLAG, 1, 2, CPU::INTERRUPT_FLAG);
+    set(CLC, LaneOp::CLEAR_FLAG, 1, 2, CPU::CARRY_FLAG);
+    set(CLD, LaneOp::CLEAR_FLAG, 1, 2, CPU::DECIMAL_FLAG);
+    set(CLI, LaneOp::CLEAR_FLAG, 1, 2, CPU::INTERRUPT_FLAG);
+    set(CLV, LaneOp::CLEAR_FLAG, 1, 2, CPU::OVERFLOW_FLAG);
+    set(JMP_ABS, LaneOp::JMP_ABS, 3, 3);
+    set(LDA_ZP, LaneOp::LOAD_ZP, 2, 3, REG_A);
+    set(LDX_ZP, LaneOp::LOAD_ZP, 2, 3, REG_X);
+    set(LDY_ZP, LaneOp::LOAD_ZP, 2, 3, REG_Y);
+    set(STA_ZP, LaneOp::STORE_ZP, 2, 3, 0, REG_A);
+    set(STX_ZP, LaneOp::STORE_ZP, 2, 3, 0, REG_X);
+    set(STY_ZP, LaneOp::STORE_ZP, 2, 3, 0, REG_Y);
+    set(INC_ZP, LaneOp::MODIFY_ZP, 2, 5, 0, 0, 0x01);
+    set(DEC_ZP, LaneOp::MODIFY_ZP, 2, 5, 0, 0, 0xFF);
+}
\ No newline at end of file
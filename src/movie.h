@@ -0,0 +1,267 @@
+#pragma once
+#include "nes.h"
+#include "save_state.h"
+#include "types.h"
+#include <string.h>
+
+// An input movie: a starting state, the controller state for every frame and the state hash after every frame. Movie files reuse the
+// save state container: the starting state's chunks followed by an input chunk and a hash chunk.
+//
+// Keyframes are full snapshots taken every keyframe_interval frames while recording or playing back. Seeking restores the nearest
+// keyframe at or before the target and fast-forwards from there with tracing, breakpoints and debug output disabled, checking every
+// frame's hash. When an attached breakpoint stops a frame part way through, the frame stays current and the next record_frame or
+// play_frame call finishes it.
+struct Movie {
+    static constexpr u32
+        INPUT_CHUNK = fourcc("INPT"),
+        HASH_CHUNK  = fourcc("HASH");
+
+    static constexpr u16
+        INPUT_CHUNK_VERSION = 1,
+        HASH_CHUNK_VERSION  = 1;
+
+    static constexpr size_t DEFAULT_KEYFRAME_INTERVAL = 60;
+
+    struct Input {
+        u8 ports[NES::PORT_COUNT];
+    };
+
+    Input* inputs         = nullptr;
+    u64* hashes           = nullptr;
+    size_t frame_count    = 0;
+    size_t frame_capacity = 0;
+
+    NES::Snapshot** keyframes = nullptr; // keyframes[k] is the state at the start of frame k * keyframe_interval
+    size_t keyframe_count     = 0;
+    size_t keyframe_interval  = DEFAULT_KEYFRAME_INTERVAL;
+    size_t position           = 0; // The next frame to record or play
+    size_t first_desync       = 0; // Frame number plus one of the first hash mismatch, zero while in sync
+
+    Movie() = default;
+    Movie(const Movie&)            = delete;
+    Movie& operator=(const Movie&) = delete;
+    ~Movie();
+
+    void clear();
+
+    void begin_recording(NES& nes);
+    void record_frame(NES& nes, const Input& input);
+
+    void begin_playback(NES& nes);
+    [[nodiscard]] bool play_frame(NES& nes);
+    [[nodiscard]] bool seek(NES& nes, const size_t frame);
+
+    [[nodiscard]] bool save(const char* path) const;
+    [[nodiscard]] bool load(const char* path);
+
+private:
+    void reserve_frames(const size_t count);
+    void capture_keyframe(NES& nes);
+    [[nodiscard]] bool run_frame(NES& nes);
+    [[nodiscard]] static bool stopped(const NES& nes);
+};
+
+Movie::~Movie() {
+    clear();
+}
+
+void Movie::clear() {
+    for(size_t i = 0; i < keyframe_count; i++) {
+        delete keyframes[i];
+    }
+    delete[] keyframes;
+    delete[] inputs;
+    delete[] hashes;
+
+    keyframes      = nullptr;
+    inputs         = nullptr;
+    hashes         = nullptr;
+    keyframe_count = 0;
+    frame_count    = 0;
+    frame_capacity = 0;
+    position       = 0;
+    first_desync   = 0;
+}
+
+void Movie::reserve_frames(const size_t count) {
+    if(count <= frame_capacity) return;
+
+    size_t capacity = frame_capacity ? frame_capacity : 1024;
+    while(capacity < count) {
+        capacity *= 2;
+    }
+
+    Input* grown_inputs = new Input[capacity];
+    u64* grown_hashes   = new u64[capacity];
+    if(frame_count) {
+        memcpy(grown_inputs, inputs, frame_count * sizeof(Input));
+        memcpy(grown_hashes, hashes, frame_count * sizeof(u64));
+    }
+    delete[] inputs;
+    delete[] hashes;
+
+    inputs         = grown_inputs;
+    hashes         = grown_hashes;
+    frame_capacity = capacity;
+
+    // One keyframe slot per interval, plus the starting state
+    NES::Snapshot** grown_keyframes = new NES::Snapshot*[capacity / keyframe_interval + 2]();
+    if(keyframe_count) {
+        memcpy(grown_keyframes, keyframes, keyframe_count * sizeof(NES::Snapshot*));
+    }
+    delete[] keyframes;
+    keyframes = grown_keyframes;
+}
+
+void Movie::capture_keyframe(NES& nes) {
+    // Keyframes are only taken in order and never from a run that has already diverged from the recording
+    const size_t index = position / keyframe_interval;
+    if(position % keyframe_interval != 0 || index != keyframe_count || first_desync != 0) return;
+
+    keyframes[index] = new NES::Snapshot;
+    nes.save_snapshot(*keyframes[index]);
+    keyframe_count = index + 1;
+}
+
+void Movie::begin_recording(NES& nes) {
+    clear();
+    reserve_frames(1);
+    capture_keyframe(nes);
+}
+
+void Movie::record_frame(NES& nes, const Input& input) {
+    // Recording after a seek replaces everything from this frame on, including keyframes taken further ahead
+    while(keyframe_count > 1 && (keyframe_count - 1) * keyframe_interval > position) {
+        delete keyframes[--keyframe_count];
+    }
+
+    reserve_frames(position + 1);
+    capture_keyframe(nes);
+
+    nes.set_input(input.ports[0], input.ports[1]);
+    nes.run_frame();
+    if(stopped(nes)) return;
+
+    inputs[position] = input;
+    hashes[position] = nes.state_hash();
+    position++;
+    frame_count = position;
+}
+
+void Movie::begin_playback(NES& nes) {
+    if(keyframe_count == 0) return; // Nothing recorded or loaded
+
+    nes.load_snapshot(*keyframes[0]);
+    position     = 0;
+    first_desync = 0;
+}
+
+bool Movie::run_frame(NES& nes) {
+    capture_keyframe(nes);
+
+    nes.set_input(inputs[position].ports[0], inputs[position].ports[1]);
+    nes.run_frame();
+    if(stopped(nes)) return true; // Only a finished frame can be checked
+
+    const bool in_sync = nes.state_hash() == hashes[position];
+    if(!in_sync && first_desync == 0) {
+        first_desync = position + 1;
+    }
+    position++;
+
+    return in_sync;
+}
+
+bool Movie::stopped(const NES& nes) {
+    return nes.breakpoints && nes.breakpoints->stopped;
+}
+
+bool Movie::play_frame(NES& nes) {
+    if(position >= frame_count) return false;
+
+    return run_frame(nes);
+}
+
+bool Movie::seek(NES& nes, const size_t frame) {
+    if(frame > frame_count || keyframe_count == 0) return false;
+
+    size_t keyframe = frame / keyframe_interval;
+    keyframe        = keyframe < keyframe_count ? keyframe : keyframe_count - 1;
+
+    nes.load_snapshot(*keyframes[keyframe]);
+    position     = keyframe * keyframe_interval;
+    first_desync = 0;
+
+    // Everything that observes execution is detached for the fast-forward, as NES::fork does for a new instance
+    NES::Observers observers;
+    observers.detach(nes);
+
+    bool in_sync = true;
+    while(position < frame) {
+        in_sync &= run_frame(nes);
+    }
+
+    observers.restore(nes);
+
+    return in_sync;
+}
+
+bool Movie::save(const char* path) const {
+    if(keyframe_count == 0) return false;
+
+    // The starting state is written through a scratch instance that shares the first keyframe's pages
+    NES start;
+    start.power_on();
+    start.load_snapshot(*keyframes[0]);
+
+    SaveState::Writer writer;
+    if(!writer.open(path)) return false;
+
+    start.write_state(writer);
+
+    const u32 count = static_cast<u32>(frame_count);
+    writer.begin_chunk(INPUT_CHUNK, INPUT_CHUNK_VERSION);
+    writer.write(&count, sizeof(count));
+    writer.write(inputs, frame_count * sizeof(Input));
+    writer.end_chunk();
+
+    writer.begin_chunk(HASH_CHUNK, HASH_CHUNK_VERSION);
+    writer.write(&count, sizeof(count));
+    writer.write(hashes, frame_count * sizeof(u64));
+    writer.end_chunk();
+
+    return writer.close();
+}
+
+bool Movie::load(const char* path) {
+    SaveState::Reader reader;
+    if(!reader.open(path)) return false;
+
+    u16 input_version, hash_version;
+    u32 input_size, hash_size;
+    const u8* input_chunk = reader.find_chunk(INPUT_CHUNK, &input_version, &input_size);
+    const u8* hash_chunk  = reader.find_chunk(HASH_CHUNK, &hash_version, &hash_size);
+    if(!input_chunk || !hash_chunk || input_version > INPUT_CHUNK_VERSION || hash_version > HASH_CHUNK_VERSION) return false;
+    if(input_size < sizeof(u32) || hash_size < sizeof(u32)) return false;
+
+    u32 count, hash_count;
+    memcpy(&count, input_chunk, sizeof(count));
+    memcpy(&hash_count, hash_chunk, sizeof(hash_count));
+    // Sizes are compared in 64 bits so that a corrupt count cannot wrap the products
+    if(hash_count != count) return false;
+    if(u64(input_size) < sizeof(u32) + u64(count) * sizeof(Input) || u64(hash_size) < sizeof(u32) + u64(count) * sizeof(u64)) return false;
+
+    NES start;
+    start.power_on();
+    if(!start.read_state(reader)) return false;
+
+    clear();
+    reserve_frames(count ? count : 1);
+    memcpy(inputs, input_chunk + sizeof(u32), count * sizeof(Input));
+    memcpy(hashes, hash_chunk + sizeof(u32), count * sizeof(u64));
+    frame_count = count;
+
+    capture_keyframe(start);
+
+    return true;
+}
\ No newline at end of file
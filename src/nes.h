@@ -0,0 +1,449 @@
+#pragma once
+#include "breakpoints.h"
+#include "cpu.h"
+#include "dma.h"
+#include "instructions.h"
+#include "pc_sampler.h"
+#include "ram.h"
+#include "save_state.h"
+#include "types.h"
+#include <string.h>
+
+// One console: the CPU, its address space and the devices mapped into the $4000 register page. Instances are not copyable or movable
+// because the register page handler points back at the instance; use snapshots to duplicate state.
+struct NES {
+    static constexpr u64 CYCLES_PER_FRAME = 29781; // NTSC is 29780.5 CPU cycles per frame, rounded up until the PPU drives timing
+    static constexpr u8 REGISTER_PAGE     = 0x40;
+    static constexpr size_t PORT_COUNT    = 2;
+
+    static constexpr u16
+        CONTROLLER_1 = 0x4016,
+        CONTROLLER_2 = 0x4017;
+
+    static constexpr u8
+        BUTTON_A      = 1 << 0,
+        BUTTON_B      = 1 << 1,
+        BUTTON_SELECT = 1 << 2,
+        BUTTON_START  = 1 << 3,
+        BUTTON_UP     = 1 << 4,
+        BUTTON_DOWN   = 1 << 5,
+        BUTTON_LEFT   = 1 << 6,
+        BUTTON_RIGHT  = 1 << 7;
+
+    // iNES cartridge images. Only mapper 0 (NROM) is supported until there is a mapper interface; CHR data is ignored without a PPU.
+    static constexpr u32 INES_MAGIC       = 0x1A53454E; // "NES" followed by an MS-DOS end of file
+    static constexpr size_t INES_HEADER   = 16;
+    static constexpr size_t INES_TRAINER  = 512;
+    static constexpr size_t PRG_BANK_SIZE = KB(16);
+    static constexpr u16 PRG_ROM          = 0x8000;
+    static constexpr u16 RESET_VECTOR     = 0xFFFC;
+
+    static constexpr u32 NES_CHUNK         = fourcc("NES ");
+    static constexpr u16 NES_CHUNK_VERSION = 1;
+
+    struct Devices {
+        u8 controllers[PORT_COUNT];      // Buttons held this frame
+        u8 controller_shift[PORT_COUNT]; // Serial read-out latched by the strobe
+        u8 controller_strobe;
+        u8 reserved[3];
+        u8 oam[DMA::OAM_SIZE];
+    };
+    static_assert(sizeof(Devices) == 8 + DMA::OAM_SIZE, "The device chunk layout is part of the save state format");
+
+    // Snapshots share memory pages with the instance they were taken from, so taking one costs a page table walk and memory is only
+    // copied when either side writes to a page afterwards.
+    struct Snapshot {
+        u16 pc;
+        u8 sp;
+        u8 a, x, y, s;
+        u64 cycles;
+        Devices devices;
+        MemoryImage memory;
+    };
+
+    // Everything that watches execution without being part of the machine state. detach() saves and detaches what is attached to an
+    // instance, restore() attaches it again; the lists are kept here so that power_on, fork and Movie::seek cannot drift apart.
+    struct Observers {
+        bool debug;
+        CPUTrace* trace;
+        TraceLog* trace_log;
+        CallGraph* call_graph;
+        CodeDataLog* cdl;
+#if defined(NES_PROFILE)
+        OpcodeProfile* profile;
+#endif
+        PCSampler* sampler;
+        Breakpoints* breakpoints;
+        BusTrace* bus_trace;
+
+        void detach(NES& nes);
+        void restore(NES& nes) const;
+    };
+
+    CPU cpu;
+    RAM ram;
+    DMA dma;
+    u8 controllers[PORT_COUNT];
+    u8 controller_shift[PORT_COUNT];
+    bool controller_strobe;
+    RAM::IOHandler registers;
+    PCSampler* sampler       = nullptr; // Samples the PC while running when attached
+    Breakpoints* breakpoints = nullptr; // Can stop run_cycles and run_frame early when attached
+    u64 instructions         = 0;       // Instructions run by run_cycles and run_frame, added up once per run
+
+    NES() = default;
+    NES(const NES&)            = delete;
+    NES& operator=(const NES&) = delete;
+
+    // Also detaches every observer and watchpoint, so that an instance recycled by an arena keeps nothing of its previous owner
+    void power_on();
+    // The reset line: memory and devices are kept, interrupts are disabled and execution restarts at the reset vector
+    void reset();
+    [[nodiscard]] bool load_rom(const u8* data, const size_t size);
+    void run_cycles(const u64 budget);
+    void run_frame();
+    [[nodiscard]] u64 frame() const;
+    void set_input(const u8 port_1, const u8 port_2);
+
+    void fork(NES& child);
+    void detach_observers(); // Detaches everything listed in Observers without keeping it
+    void save_snapshot(Snapshot& snapshot);
+    void load_snapshot(const Snapshot& snapshot);
+    [[nodiscard]] u64 state_hash() const;
+
+    void write_state(SaveState::Writer& writer) const;
+    [[nodiscard]] bool read_state(const SaveState::Reader& reader);
+    [[nodiscard]] bool save(const char* path) const;
+    [[nodiscard]] bool load(const char* path);
+
+private:
+    void run_until(const u64 end);
+    bool run_to(const u64 stop, u64& executed);
+    [[nodiscard]] Devices capture_devices() const;
+    void restore_devices(const Devices& devices);
+    [[nodiscard]] static u64 mix_hash(const u64 hash, const u64 value);
+
+    static u8 read_register(void* context, const u16 address);
+    static void write_register(void* context, const u16 address, const u8 data);
+};
+
+void NES::power_on() {
+    load_instructions(cpu);
+    cpu.reset();
+    detach_observers();
+
+    ram.release();
+    ram.clear_watchpoints();
+    registers = {read_register, write_register, this};
+    ram.map_io(&registers, REGISTER_PAGE, REGISTER_PAGE);
+
+    memset(dma.oam, 0, sizeof(dma.oam));
+    memset(controllers, 0, sizeof(controllers));
+    memset(controller_shift, 0, sizeof(controller_shift));
+    controller_strobe = false;
+}
+
+bool NES::load_rom(const u8* data, const size_t size) {
+    if(size < INES_HEADER) return false;
+
+    u32 magic;
+    memcpy(&magic, data, sizeof(magic));
+    const size_t prg_banks = data[4];
+    const u8 mapper        = (data[6] >> 4) | (data[7] & 0xF0);
+    const size_t prg_start = INES_HEADER + ((data[6] & 0x04) ? INES_TRAINER : 0);
+
+    if(magic != INES_MAGIC || mapper != 0 || prg_banks < 1 || prg_banks > 2) return false;
+    if(size < prg_start + prg_banks * PRG_BANK_SIZE) return false;
+
+    power_on();
+
+    // A single 16 KB bank is mirrored into both halves of the cartridge space
+    ram.load_block(PRG_ROM, &data[prg_start], prg_banks * PRG_BANK_SIZE);
+    if(prg_banks == 1) {
+        ram.load_block(PRG_ROM + PRG_BANK_SIZE, &data[prg_start], PRG_BANK_SIZE);
+    }
+
+    reset();
+
+    return true;
+}
+
+void NES::reset() {
+    // The reset sequence runs three stack cycles with writes suppressed, which is also where the $FD power-on stack pointer comes from
+    cpu.sp -= 3;
+    cpu.set_status(CPU::INTERRUPT_FLAG, true);
+    cpu.pc = ram.read(RESET_VECTOR) | (ram.read(RESET_VECTOR + 1) << 8);
+    if(cpu.cdl) {
+        cpu.cdl->log_data(RESET_VECTOR, 2);
+    }
+}
+
+void NES::run_cycles(const u64 budget) {
+    run_until(cpu.cycles + budget);
+}
+
+void NES::run_frame() {
+    run_until((frame() + 1) * CYCLES_PER_FRAME);
+}
+
+void NES::run_until(const u64 end) {
+    u64 executed = 0;
+    bool running = true;
+    if(breakpoints) {
+        breakpoints->stopped      = false;
+        breakpoints->access_count = 0; // Accesses made between runs are the host's, not the program's
+    }
+
+    // Sampling splits the run at each sample point, so the instruction loop itself is the same with or without a sampler
+    while(running && sampler && cpu.cycles < end) {
+        running = run_to(sampler->next < end ? sampler->next : end, executed);
+
+        if(cpu.cycles >= sampler->next) {
+            sampler->sample(cpu.pc, cpu.cycles);
+        }
+    }
+
+    if(running) {
+        run_to(end, executed);
+    }
+
+    instructions += executed;
+}
+
+// Returns false when a breakpoint stopped the run before stop
+bool NES::run_to(const u64 stop, u64& executed) {
+    if(breakpoints) {
+        while(cpu.cycles < stop) {
+            if(breakpoints->check(cpu, ram)) return false;
+
+            cpu.execute(ram);
+            executed++;
+        }
+        // Watched accesses made by the last instruction stop this run rather than the next
+        return !(breakpoints->access_count && breakpoints->check(cpu, ram));
+    }
+
+    while(cpu.cycles < stop) {
+        cpu.execute(ram);
+        executed++;
+    }
+    return true;
+}
+
+u64 NES::frame() const {
+    return cpu.cycles / CYCLES_PER_FRAME;
+}
+
+void NES::set_input(const u8 port_1, const u8 port_2) {
+    controllers[0] = port_1;
+    controllers[1] = port_2;
+}
+
+void NES::fork(NES& child) {
+    // The child's instruction table is copied along with the registers, so it does not need powering on first
+    // The child starts with nothing attached; a trace ring, for one, has a single producer
+    child.cpu = cpu;
+    child.detach_observers();
+    child.restore_devices(capture_devices());
+
+    child.registers = {read_register, write_register, &child};
+    child.ram.map_io(&child.registers, REGISTER_PAGE, REGISTER_PAGE);
+    ram.fork(child.ram);
+}
+
+void NES::detach_observers() {
+    Observers observers;
+    observers.detach(*this);
+}
+
+void NES::Observers::detach(NES& nes) {
+    debug       = nes.cpu.debug;
+    trace       = nes.cpu.trace;
+    trace_log   = nes.cpu.trace_log;
+    call_graph  = nes.cpu.call_graph;
+    cdl         = nes.cpu.cdl;
+    sampler     = nes.sampler;
+    breakpoints = nes.breakpoints;
+    bus_trace   = nes.ram.attached_trace();
+#if defined(NES_PROFILE)
+    profile = nes.cpu.profile;
+#endif
+
+    nes.cpu.debug = false;
+    nes.cpu.detach_observers();
+    nes.sampler     = nullptr;
+    nes.breakpoints = nullptr;
+    nes.ram.attach_trace(nullptr);
+}
+
+void NES::Observers::restore(NES& nes) const {
+    nes.cpu.debug      = debug;
+    nes.cpu.trace      = trace;
+    nes.cpu.trace_log  = trace_log;
+    nes.cpu.call_graph = call_graph;
+    nes.cpu.cdl        = cdl;
+    nes.sampler        = sampler;
+    nes.breakpoints    = breakpoints;
+    nes.ram.attach_trace(bus_trace);
+#if defined(NES_PROFILE)
+    nes.cpu.profile = profile;
+#endif
+}
+
+NES::Devices NES::capture_devices() const {
+    Devices devices           = {};
+    devices.controller_strobe = controller_strobe;
+    memcpy(devices.controllers, controllers, sizeof(controllers));
+    memcpy(devices.controller_shift, controller_shift, sizeof(controller_shift));
+    memcpy(devices.oam, dma.oam, sizeof(dma.oam));
+
+    return devices;
+}
+
+void NES::restore_devices(const Devices& devices) {
+    controller_strobe = devices.controller_strobe & 1;
+    memcpy(controllers, devices.controllers, sizeof(controllers));
+    memcpy(controller_shift, devices.controller_shift, sizeof(controller_shift));
+    memcpy(dma.oam, devices.oam, sizeof(dma.oam));
+}
+
+void NES::save_snapshot(Snapshot& snapshot) {
+    snapshot.pc      = cpu.pc;
+    snapshot.sp      = cpu.sp;
+    snapshot.a       = cpu.a;
+    snapshot.x       = cpu.x;
+    snapshot.y       = cpu.y;
+    snapshot.s       = cpu.s;
+    snapshot.cycles  = cpu.cycles;
+    snapshot.devices = capture_devices();
+    ram.share(snapshot.memory);
+}
+
+void NES::load_snapshot(const Snapshot& snapshot) {
+    cpu.pc     = snapshot.pc;
+    cpu.sp     = snapshot.sp;
+    cpu.a      = snapshot.a;
+    cpu.x      = snapshot.x;
+    cpu.y      = snapshot.y;
+    cpu.s      = snapshot.s;
+    cpu.cycles = snapshot.cycles;
+    restore_devices(snapshot.devices);
+    ram.attach(snapshot.memory);
+}
+
+u64 NES::mix_hash(const u64 hash, const u64 value) {
+    static constexpr u64 PRIME = 0x100000001B3;
+
+    const u64 mixed = (hash ^ value) * PRIME;
+    return mixed ^ (mixed >> 29);
+}
+
+u64 NES::state_hash() const {
+    static constexpr u8 zero_page[RAM::PAGE_SIZE] = {};
+
+    u64 hash = 0xCBF29CE484222325;
+    hash     = mix_hash(hash, cpu.pc | (u64(cpu.sp) << 16) | (u64(cpu.a) << 24) | (u64(cpu.x) << 32) | (u64(cpu.y) << 40) | (u64(cpu.s) << 48));
+    hash     = mix_hash(hash, cpu.cycles);
+
+    const Devices devices = capture_devices();
+    const u8* bytes       = reinterpret_cast<const u8*>(&devices);
+    for(size_t i = 0; i < sizeof(devices); i += sizeof(u64)) {
+        u64 word;
+        memcpy(&word, &bytes[i], sizeof(word));
+        hash = mix_hash(hash, word);
+    }
+
+    // Untouched pages hash as zeros so that equal memory contents always hash equally, however the pages came to be
+    for(size_t page = 0; page < RAM::PAGE_COUNT; page++) {
+        const u8* data = ram.page_data(static_cast<u8>(page));
+        data           = data ? data : zero_page;
+
+        for(size_t i = 0; i < RAM::PAGE_SIZE; i += sizeof(u64)) {
+            u64 word;
+            memcpy(&word, &data[i], sizeof(word));
+            hash = mix_hash(hash, word);
+        }
+    }
+
+    return hash;
+}
+
+void NES::write_state(SaveState::Writer& writer) const {
+    const Devices devices = capture_devices();
+
+    SaveState::write_cpu(writer, cpu);
+    SaveState::write_ram(writer, ram);
+
+    writer.begin_chunk(NES_CHUNK, NES_CHUNK_VERSION);
+    writer.write(&devices, sizeof(devices));
+    writer.end_chunk();
+}
+
+bool NES::read_state(const SaveState::Reader& reader) {
+    SaveState::CPUChunk registers;
+    MemoryImage memory;
+    if(!SaveState::read_cpu(reader, registers) || !SaveState::read_ram(reader, memory)) return false;
+
+    u16 version;
+    u32 size;
+    Devices devices   = {};
+    const u8* payload = reader.find_chunk(NES_CHUNK, &version, &size);
+    if(payload && version <= NES_CHUNK_VERSION) {
+        memcpy(&devices, payload, size < sizeof(devices) ? size : sizeof(devices));
+    }
+
+    SaveState::restore_cpu(cpu, registers);
+    restore_devices(devices);
+    ram.attach(memory);
+
+    return true;
+}
+
+bool NES::save(const char* path) const {
+    SaveState::Writer writer;
+    if(!writer.open(path)) return false;
+
+    write_state(writer);
+
+    return writer.close();
+}
+
+bool NES::load(const char* path) {
+    SaveState::Reader reader;
+    if(!reader.open(path)) return false;
+
+    return read_state(reader);
+}
+
+u8 NES::read_register(void* context, const u16 address) {
+    NES& nes = *static_cast<NES*>(context);
+
+    // Unconnected register bits read back the high byte of the address, which was the last value on the data bus
+    static constexpr u8 OPEN_BUS = 0x40;
+
+    if(address == CONTROLLER_1 || address == CONTROLLER_2) {
+        const size_t port = address - CONTROLLER_1;
+        if(nes.controller_strobe) {
+            return OPEN_BUS | (nes.controllers[port] & 1);
+        }
+
+        const u8 bit               = nes.controller_shift[port] & 1;
+        nes.controller_shift[port] = (nes.controller_shift[port] >> 1) | 0x80; // Reads past the eighth button return 1
+        return OPEN_BUS | bit;
+    }
+
+    return OPEN_BUS;
+}
+
+void NES::write_register(void* context, const u16 address, const u8 data) {
+    NES& nes = *static_cast<NES*>(context);
+
+    if(address == DMA::OAM_DMA) {
+        nes.dma.oam_transfer(nes.cpu, nes.ram, data);
+    } else if(address == CONTROLLER_1) {
+        nes.controller_strobe = data & 1;
+        if(nes.controller_strobe) {
+            memcpy(nes.controller_shift, nes.controllers, sizeof(nes.controllers));
+        }
+    }
+}
\ No newline at end of file
@@ -0,0 +1,85 @@
+#define NES_API_BUILD
+#include "nes_api.h"
+#include "nes.h"
+#include <new>
+
+struct nes_instance {
+    NES nes;
+};
+
+uint32_t nes_api_version(void) {
+    return NES_API_VERSION;
+}
+
+nes_instance* nes_create(void) {
+    nes_instance* instance = new(std::nothrow) nes_instance;
+    if(instance) {
+        instance->nes.power_on();
+    }
+
+    return instance;
+}
+
+void nes_destroy(nes_instance* instance) {
+    delete instance;
+}
+
+nes_result nes_load_rom(nes_instance* instance, const uint8_t* data, size_t size) {
+    return instance->nes.load_rom(data, size) ? NES_OK : NES_INVALID_ROM;
+}
+
+void nes_reset(nes_instance* instance) {
+    instance->nes.reset();
+}
+
+void nes_run_cycles(nes_instance* instance, uint64_t cycles) {
+    instance->nes.run_cycles(cycles);
+}
+
+void nes_run_frames(nes_instance* instance, uint32_t frames) {
+    for(uint32_t i = 0; i < frames; i++) {
+        instance->nes.run_frame();
+    }
+}
+
+void nes_set_input(nes_instance* instance, uint8_t port_1, uint8_t port_2) {
+    instance->nes.set_input(port_1, port_2);
+}
+
+uint64_t nes_cycles(const nes_instance* instance) {
+    return instance->nes.cpu.cycles;
+}
+
+uint64_t nes_frame(const nes_instance* instance) {
+    return instance->nes.frame();
+}
+
+uint8_t nes_read(nes_instance* instance, uint16_t address) {
+    return instance->nes.ram.read(address);
+}
+
+void nes_write(nes_instance* instance, uint16_t address, uint8_t value) {
+    instance->nes.ram.write(address, value);
+}
+
+const uint8_t* nes_page(const nes_instance* instance, uint8_t page) {
+    return instance->nes.ram.page_data(page);
+}
+
+nes_result nes_save_state(const nes_instance* instance, const char* path) {
+    return instance->nes.save(path) ? NES_OK : NES_IO_ERROR;
+}
+
+nes_result nes_load_state(nes_instance* instance, const char* path) {
+    SaveState::Reader reader;
+    if(!reader.open(path)) return NES_IO_ERROR;
+
+    return instance->nes.read_state(reader) ? NES_OK : NES_INVALID_STATE;
+}
+
+const uint32_t* nes_framebuffer(const nes_instance* instance, uint32_t* width, uint32_t* height) {
+    if(width) *width = 0;
+    if(height) *height = 0;
+
+    return nullptr;
+}
\ No newline at end of file
@@ -0,0 +1,69 @@
+#pragma once
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * C interface for embedding the emulator. Instances are opaque handles owned by the caller. Nothing on the per-frame path
+ * (nes_run_cycles, nes_run_frames, nes_set_input, memory access) allocates, and memory is exposed in place rather than copied out.
+ * The ABI only grows: new functions are added at the end and NES_API_VERSION is bumped, existing signatures never change.
+ */
+
+#define NES_API_VERSION 1
+
+#if defined(_WIN32)
+    #if defined(NES_API_BUILD)
+        #define NES_API __declspec(dllexport)
+    #else
+        #define NES_API __declspec(dllimport)
+    #endif
+#else
+    #define NES_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+typedef struct nes_instance nes_instance;
+
+typedef enum nes_result {
+    NES_OK            = 0,
+    NES_INVALID_ROM   = 1, /* Not an iNES image, or a mapper other than NROM */
+    NES_IO_ERROR      = 2,
+    NES_INVALID_STATE = 3, /* The file is not a compatible save state */
+} nes_result;
+
+NES_API uint32_t nes_api_version(void);
+
+NES_API nes_instance* nes_create(void);
+NES_API void nes_destroy(nes_instance* instance);
+
+/* Powers the instance on and maps the cartridge; execution starts at the reset vector */
+NES_API nes_result nes_load_rom(nes_instance* instance, const uint8_t* data, size_t size);
+/* Presses the reset button: memory and the loaded cartridge are kept and execution restarts at the reset vector */
+NES_API void nes_reset(nes_instance* instance);
+
+NES_API void nes_run_cycles(nes_instance* instance, uint64_t cycles);
+NES_API void nes_run_frames(nes_instance* instance, uint32_t frames);
+NES_API void nes_set_input(nes_instance* instance, uint8_t port_1, uint8_t port_2);
+NES_API uint64_t nes_cycles(const nes_instance* instance);
+NES_API uint64_t nes_frame(const nes_instance* instance);
+
+NES_API uint8_t nes_read(nes_instance* instance, uint16_t address);
+NES_API void nes_write(nes_instance* instance, uint16_t address, uint8_t value);
+
+/*
+ * Read-only view of one 256 byte page of the address space, valid until the instance next writes to that page or is destroyed.
+ * Returns NULL for pages that read as zero and for memory mapped register pages.
+ */
+NES_API const uint8_t* nes_page(const nes_instance* instance, uint8_t page);
+
+NES_API nes_result nes_save_state(const nes_instance* instance, const char* path);
+NES_API nes_result nes_load_state(nes_instance* instance, const char* path);
+
+/* There is no PPU yet: this always returns NULL and sets width and height to 0 */
+NES_API const uint32_t* nes_framebuffer(const nes_instance* instance, uint32_t* width, uint32_t* height);
+
+#ifdef __cplusplus
+}
+#endif
\ No newline at end of file
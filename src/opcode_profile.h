@@ -0,0 +1,193 @@
+#pragma once
+#include "opcodes.h"
+#include "types.h"
+#include <stdio.h>
+#include <string.h>
+
+// Per-opcode execution counts, split by the number of cycles each execution took. Building with NES_PROFILE defined makes
+// CPU::execute record every instruction into the profile attached to the CPU; without it the hook is compiled out entirely.
+//
+// Each instruction costs a single increment: the count for an opcode, its total cycles and its cycle histogram are all derived from
+// one (opcode, cycles taken) cell when the profile is written out. Executions of CYCLE_BUCKETS - 1 cycles or more, such as writes
+// that trigger DMA, share the last bucket, and their true cycle counts are added up separately so that the totals stay exact.
+struct OpcodeProfile {
+    static constexpr size_t CYCLE_BUCKETS = 16;
+
+    u64 counts[256][CYCLE_BUCKETS];
+    u64 long_cycles[256]; // Cycles taken by the executions in the last bucket
+    const char* dump_path = nullptr; // Written out by the destructor when set, so a static profile is dumped at exit
+
+    OpcodeProfile();
+    OpcodeProfile(const OpcodeProfile&)            = delete;
+    OpcodeProfile& operator=(const OpcodeProfile&) = delete;
+    ~OpcodeProfile();
+
+    void record(const u8 opcode, const u64 cycles_taken);
+    void merge(const OpcodeProfile& other);
+    void clear();
+
+    [[nodiscard]] u64 count(const u8 opcode) const;
+    [[nodiscard]] u64 cycles(const u8 opcode) const;
+
+    // Rows are ordered by execution count, most frequent first, and opcodes that never ran are left out
+    void write_csv(FILE* file) const;
+    void write_json(FILE* file) const;
+    [[nodiscard]] bool dump(const char* path) const; // JSON when the path ends in .json, CSV otherwise
+
+private:
+    size_t sorted_opcodes(u8* order) const;
+};
+
+OpcodeProfile::OpcodeProfile() {
+    clear();
+}
+
+OpcodeProfile::~OpcodeProfile() {
+    if(dump_path && !dump(dump_path)) {
+        printf("Unable to write the opcode profile to %s\n", dump_path);
+    }
+}
+
+void OpcodeProfile::record(const u8 opcode, const u64 cycles_taken) {
+    if(cycles_taken < CYCLE_BUCKETS - 1) {
+        counts[opcode][cycles_taken]++;
+    } else {
+        counts[opcode][CYCLE_BUCKETS - 1]++;
+        long_cycles[opcode] += cycles_taken;
+    }
+}
+
+void OpcodeProfile::merge(const OpcodeProfile& other) {
+    for(size_t opcode = 0; opcode < 256; opcode++) {
+        for(size_t bucket = 0; bucket < CYCLE_BUCKETS; bucket++) {
+            counts[opcode][bucket] += other.counts[opcode][bucket];
+        }
+        long_cycles[opcode] += other.long_cycles[opcode];
+    }
+}
+
+void OpcodeProfile::clear() {
+    memset(counts, 0, sizeof(counts));
+    memset(long_cycles, 0, sizeof(long_cycles));
+}
+
+u64 OpcodeProfile::count(const u8 opcode) const {
+    u64 total = 0;
+    for(const u64 bucket : counts[opcode]) {
+        total += bucket;
+    }
+    return total;
+}
+
+u64 OpcodeProfile::cycles(const u8 opcode) const {
+    u64 total = long_cycles[opcode];
+    for(size_t bucket = 0; bucket < CYCLE_BUCKETS - 1; bucket++) {
+        total += counts[opcode][bucket] * bucket;
+    }
+    return total;
+}
+
+size_t OpcodeProfile::sorted_opcodes(u8* order) const {
+    u64 totals[256];
+    size_t used = 0;
+    for(size_t opcode = 0; opcode < 256; opcode++) {
+        totals[opcode] = count(static_cast<u8>(opcode));
+        if(totals[opcode]) {
+            order[used++] = static_cast<u8>(opcode);
+        }
+    }
+
+    // At most 256 entries, so an insertion sort is plenty
+    for(size_t i = 1; i < used; i++) {
+        const u8 opcode = order[i];
+        size_t j        = i;
+        while(j > 0 && totals[order[j - 1]] < totals[opcode]) {
+            order[j] = order[j - 1];
+            j--;
+        }
+        order[j] = opcode;
+    }
+
+    return used;
+}
+
+void OpcodeProfile::write_csv(FILE* file) const {
+    fprintf(file, "opcode,mnemonic,mode,count,cycles");
+    for(size_t bucket = 0; bucket < CYCLE_BUCKETS; bucket++) {
+        fprintf(file, ",c%zu", bucket);
+    }
+    fprintf(file, "\n");
+
+    u8 order[256];
+    const size_t used = sorted_opcodes(order);
+    for(size_t i = 0; i < used; i++) {
+        const u8 opcode        = order[i];
+        const OpcodeInfo& info = Opcodes::info(opcode);
+
+        fprintf(file, "%2.2X,%s,%s,%llu,%llu", opcode, info.mnemonic, Opcodes::mode_name(info.mode), (unsigned long long)count(opcode),
+                (unsigned long long)cycles(opcode));
+        for(const u64 bucket : counts[opcode]) {
+            fprintf(file, ",%llu", (unsigned long long)bucket);
+        }
+        fprintf(file, "\n");
+    }
+}
+
+void OpcodeProfile::write_json(FILE* file) const {
+    static constexpr size_t MODE_COUNT = sizeof(Opcodes::mode_names) / sizeof(Opcodes::mode_names[0]);
+
+    u64 mode_counts[MODE_COUNT] = {};
+    u64 mode_cycles[MODE_COUNT] = {};
+    u64 total_count             = 0;
+    u64 total_cycles            = 0;
+
+    u8 order[256];
+    const size_t used = sorted_opcodes(order);
+    for(size_t i = 0; i < used; i++) {
+        const size_t mode = static_cast<size_t>(Opcodes::info(order[i]).mode);
+        mode_counts[mode] += count(order[i]);
+        mode_cycles[mode] += cycles(order[i]);
+        total_count += count(order[i]);
+        total_cycles += cycles(order[i]);
+    }
+
+    fprintf(file, "{\n  \"instructions\": %llu,\n  \"cycles\": %llu,\n  \"opcodes\": [", (unsigned long long)total_count,
+            (unsigned long long)total_cycles);
+    for(size_t i = 0; i < used; i++) {
+        const u8 opcode        = order[i];
+        const OpcodeInfo& info = Opcodes::info(opcode);
+
+        fprintf(file, "%s\n    {\"opcode\": \"%2.2X\", \"mnemonic\": \"%s\", \"mode\": \"%s\", \"count\": %llu, \"cycles\": %llu, \"histogram\": [",
+                i ? "," : "", opcode, info.mnemonic, Opcodes::mode_name(info.mode), (unsigned long long)count(opcode),
+                (unsigned long long)cycles(opcode));
+        for(size_t bucket = 0; bucket < CYCLE_BUCKETS; bucket++) {
+            fprintf(file, "%s%llu", bucket ? ", " : "", (unsigned long long)counts[opcode][bucket]);
+        }
+        fprintf(file, "]}");
+    }
+
+    fprintf(file, "\n  ],\n  \"modes\": {");
+    bool first = true;
+    for(size_t mode = 0; mode < MODE_COUNT; mode++) {
+        if(!mode_counts[mode]) continue;
+
+        fprintf(file, "%s\n    \"%s\": {\"count\": %llu, \"cycles\": %llu}", first ? "" : ",", Opcodes::mode_names[mode],
+                (unsigned long long)mode_counts[mode], (unsigned long long)mode_cycles[mode]);
+        first = false;
+    }
+    fprintf(file, "\n  }\n}\n");
+}
+
+bool OpcodeProfile::dump(const char* path) const {
+    FILE* file = fopen(path, "wb");
+    if(!file) return false;
+
+    const size_t length = strlen(path);
+    if(length >= 5 && strcmp(&path[length - 5], ".json") == 0) {
+        write_json(file);
+    } else {
+        write_csv(file);
+    }
+
+    return fclose(file) == 0;
+}
\ No newline at end of file
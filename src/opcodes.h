@@ -0,0 +1,72 @@
+#pragma once
+#include "types.h"
+
+// Addressing modes, named with the same suffixes as the opcode constants in instructions.h
+enum class AddressingMode : u8 {
+    IMP,  // Implied
+    ACC,  // Accumulator
+    IMM,  // #$nn
+    ZP,   // $nn
+    ZPX,  // $nn,X
+    ZPY,  // $nn,Y
+    ABS,  // $nnnn
+    ABSX, // $nnnn,X
+    ABSY, // $nnnn,Y
+    IND,  // ($nnnn)
+    INDX, // ($nn,X)
+    INDY, // ($nn),Y
+    REL,  // Branch offset
+    NONE, // Not an official opcode
+};
+
+struct OpcodeInfo {
+    const char* mnemonic;
+    AddressingMode mode;
+};
+
+// Metadata for every official 6502 opcode, whether or not the CPU implements a handler for it yet
+struct Opcodes {
+    using enum AddressingMode;
+
+    static constexpr OpcodeInfo table[256] = {
+        /* 00 */ {"BRK", IMP}, {"ORA", INDX}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"ORA", ZP}, {"ASL", ZP}, {"???", NONE},
+        /* 08 */ {"PHP", IMP}, {"ORA", IMM}, {"ASL", ACC}, {"???", NONE}, {"???", NONE}, {"ORA", ABS}, {"ASL", ABS}, {"???", NONE},
+        /* 10 */ {"BPL", REL}, {"ORA", INDY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"ORA", ZPX}, {"ASL", ZPX}, {"???", NONE},
+        /* 18 */ {"CLC", IMP}, {"ORA", ABSY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"ORA", ABSX}, {"ASL", ABSX}, {"???", NONE},
+        /* 20 */ {"JSR", ABS}, {"AND", INDX}, {"???", NONE}, {"???", NONE}, {"BIT", ZP}, {"AND", ZP}, {"ROL", ZP}, {"???", NONE},
+        /* 28 */ {"PLP", IMP}, {"AND", IMM}, {"ROL", ACC}, {"???", NONE}, {"BIT", ABS}, {"AND", ABS}, {"ROL", ABS}, {"???", NONE},
+        /* 30 */ {"BMI", REL}, {"AND", INDY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"AND", ZPX}, {"ROL", ZPX}, {"???", NONE},
+        /* 38 */ {"SEC", IMP}, {"AND", ABSY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"AND", ABSX}, {"ROL", ABSX}, {"???", NONE},
+        /* 40 */ {"RTI", IMP}, {"EOR", INDX}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"EOR", ZP}, {"LSR", ZP}, {"???", NONE},
+        /* 48 */ {"PHA", IMP}, {"EOR", IMM}, {"LSR", ACC}, {"???", NONE}, {"JMP", ABS}, {"EOR", ABS}, {"LSR", ABS}, {"???", NONE},
+        /* 50 */ {"BVC", REL}, {"EOR", INDY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"EOR", ZPX}, {"LSR", ZPX}, {"???", NONE},
+        /* 58 */ {"CLI", IMP}, {"EOR", ABSY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"EOR", ABSX}, {"LSR", ABSX}, {"???", NONE},
+        /* 60 */ {"RTS", IMP}, {"ADC", INDX}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"ADC", ZP}, {"ROR", ZP}, {"???", NONE},
+        /* 68 */ {"PLA", IMP}, {"ADC", IMM}, {"ROR", ACC}, {"???", NONE}, {"JMP", IND}, {"ADC", ABS}, {"ROR", ABS}, {"???", NONE},
+        /* 70 */ {"BVS", REL}, {"ADC", INDY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"ADC", ZPX}, {"ROR", ZPX}, {"???", NONE},
+        /* 78 */ {"SEI", IMP}, {"ADC", ABSY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"ADC", ABSX}, {"ROR", ABSX}, {"???", NONE},
+        /* 80 */ {"???", NONE}, {"STA", INDX}, {"???", NONE}, {"???", NONE}, {"STY", ZP}, {"STA", ZP}, {"STX", ZP}, {"???", NONE},
+        /* 88 */ {"DEY", IMP}, {"???", NONE}, {"TXA", IMP}, {"???", NONE}, {"STY", ABS}, {"STA", ABS}, {"STX", ABS}, {"???", NONE},
+        /* 90 */ {"BCC", REL}, {"STA", INDY}, {"???", NONE}, {"???", NONE}, {"STY", ZPX}, {"STA", ZPX}, {"STX", ZPY}, {"???", NONE},
+        /* 98 */ {"TYA", IMP}, {"STA", ABSY}, {"TXS", IMP}, {"???", NONE}, {"???", NONE}, {"STA", ABSX}, {"???", NONE}, {"???", NONE},
+        /* A0 */ {"LDY", IMM}, {"LDA", INDX}, {"LDX", IMM}, {"???", NONE}, {"LDY", ZP}, {"LDA", ZP}, {"LDX", ZP}, {"???", NONE},
+        /* A8 */ {"TAY", IMP}, {"LDA", IMM}, {"TAX", IMP}, {"???", NONE}, {"LDY", ABS}, {"LDA", ABS}, {"LDX", ABS}, {"???", NONE},
+        /* B0 */ {"BCS", REL}, {"LDA", INDY}, {"???", NONE}, {"???", NONE}, {"LDY", ZPX}, {"LDA", ZPX}, {"LDX", ZPY}, {"???", NONE},
+        /* B8 */ {"CLV", IMP}, {"LDA", ABSY}, {"TSX", IMP}, {"???", NONE}, {"LDY", ABSX}, {"LDA", ABSX}, {"LDX", ABSY}, {"???", NONE},
+        /* C0 */ {"CPY", IMM}, {"CMP", INDX}, {"???", NONE}, {"???", NONE}, {"CPY", ZP}, {"CMP", ZP}, {"DEC", ZP}, {"???", NONE},
+        /* C8 */ {"INY", IMP}, {"CMP", IMM}, {"DEX", IMP}, {"???", NONE}, {"CPY", ABS}, {"CMP", ABS}, {"DEC", ABS}, {"???", NONE},
+        /* D0 */ {"BNE", REL}, {"CMP", INDY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"CMP", ZPX}, {"DEC", ZPX}, {"???", NONE},
+        /* D8 */ {"CLD", IMP}, {"CMP", ABSY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"CMP", ABSX}, {"DEC", ABSX}, {"???", NONE},
+        /* E0 */ {"CPX", IMM}, {"SBC", INDX}, {"???", NONE}, {"???", NONE}, {"CPX", ZP}, {"SBC", ZP}, {"INC", ZP}, {"???", NONE},
+        /* E8 */ {"INX", IMP}, {"SBC", IMM}, {"NOP", IMP}, {"???", NONE}, {"CPX", ABS}, {"SBC", ABS}, {"INC", ABS}, {"???", NONE},
+        /* F0 */ {"BEQ", REL}, {"SBC", INDY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"SBC", ZPX}, {"INC", ZPX}, {"???", NONE},
+        /* F8 */ {"SED", IMP}, {"SBC", ABSY}, {"???", NONE}, {"???", NONE}, {"???", NONE}, {"SBC", ABSX}, {"INC", ABSX}, {"???", NONE}
+    };
+
+    static constexpr u8 lengths[]             = {1, 1, 2, 2, 2, 2, 3, 3, 3, 3, 2, 2, 2, 1};
+    static constexpr const char* mode_names[] = {"IMP", "ACC", "IMM", "ZP", "ZPX", "ZPY", "ABS", "ABSX", "ABSY", "IND", "INDX", "INDY", "REL", "NONE"};
+
+    [[nodiscard]] static constexpr const OpcodeInfo& info(const u8 opcode) { return table[opcode]; }
+    [[nodiscard]] static constexpr u8 length(const u8 opcode) { return lengths[static_cast<u8>(table[opcode].mode)]; }
+    [[nodiscard]] static constexpr const char* mode_name(const AddressingMode mode) { return mode_names[static_cast<u8>(mode)]; }
+};
\ No newline at end of file
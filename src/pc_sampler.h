@@ -0,0 +1,153 @@
+#pragma once
+#include "symbols.h"
+#include "types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Statistical profile of where the guest spends its time: the PC is sampled every period cycles into a histogram over the whole
+// address space. The NES run loop stops at each sample point rather than checking inside the instruction loop, so the cost to the
+// host is one histogram increment per sample. The PC recorded is the next instruction to run at the first instruction boundary at or
+// after the sample point.
+struct PCSampler {
+    static constexpr u64 DEFAULT_PERIOD = 997; // Prime, so samples do not lock step with guest loops of a round length
+
+    u32* histogram = nullptr; // One counter per address
+    u64 period     = 0;
+    u64 next       = 0; // Cycle of the next sample
+    u64 samples    = 0;
+
+    PCSampler() = default;
+    PCSampler(const PCSampler&)            = delete;
+    PCSampler& operator=(const PCSampler&) = delete;
+    ~PCSampler();
+
+    void init(const u64 sample_period, const u64 start_cycle);
+    void shutdown();
+    void clear();
+
+    void sample(const u16 pc, const u64 cycle);
+
+    // Samples are grouped by the closest label at or below each address. Without symbols only the hottest addresses are listed.
+    void report(FILE* file, const SymbolTable* symbols, const size_t limit = 20) const;
+
+private:
+    struct Entry {
+        u64 samples;
+        u32 key;
+    };
+    static int compare(const void* left, const void* right);
+    static void print_entries(FILE* file, Entry* entries, const size_t count, const size_t limit, const u64 total,
+                              const SymbolTable* symbols, const bool functions);
+};
+
+PCSampler::~PCSampler() {
+    shutdown();
+}
+
+void PCSampler::init(const u64 sample_period, const u64 start_cycle) {
+    if(!histogram) {
+        histogram = new u32[0x10000];
+    }
+
+    period = sample_period ? sample_period : DEFAULT_PERIOD;
+    next   = start_cycle + period;
+    clear();
+}
+
+void PCSampler::shutdown() {
+    delete[] histogram;
+    histogram = nullptr;
+}
+
+void PCSampler::clear() {
+    if(histogram) {
+        memset(histogram, 0, 0x10000 * sizeof(u32));
+    }
+    samples = 0;
+}
+
+void PCSampler::sample(const u16 pc, const u64 cycle) {
+    histogram[pc]++;
+    samples++;
+
+    next += period;
+    if(next <= cycle) {
+        next = cycle + period;
+    }
+}
+
+int PCSampler::compare(const void* left, const void* right) {
+    const Entry* a = static_cast<const Entry*>(left);
+    const Entry* b = static_cast<const Entry*>(right);
+
+    if(a->samples != b->samples) return a->samples > b->samples ? -1 : 1;
+    return a->key < b->key ? -1 : (a->key > b->key ? 1 : 0);
+}
+
+void PCSampler::print_entries(FILE* file, Entry* entries, const size_t count, const size_t limit, const u64 total,
+                              const SymbolTable* symbols, const bool functions) {
+    qsort(entries, count, sizeof(Entry), compare);
+
+    for(size_t i = 0; i < count && i < limit; i++) {
+        const double percent = 100.0 * static_cast<double>(entries[i].samples) / static_cast<double>(total);
+        fprintf(file, "  %6.2f%% %10llu  ", percent, (unsigned long long)entries[i].samples);
+
+        if(functions) {
+            const SymbolTable::Symbol* symbol = entries[i].key < symbols->count ? &symbols->symbols[entries[i].key] : nullptr;
+            if(symbol) {
+                fprintf(file, "%s ($%4.4X)\n", symbols->name(*symbol), symbol->address);
+            } else {
+                fprintf(file, "<below first label>\n");
+            }
+            continue;
+        }
+
+        const u16 address                 = static_cast<u16>(entries[i].key);
+        const SymbolTable::Symbol* symbol = symbols ? symbols->find(address) : nullptr;
+        if(symbol) {
+            fprintf(file, "$%4.4X  %s+%u\n", address, symbols->name(*symbol), address - symbol->address);
+        } else {
+            fprintf(file, "$%4.4X\n", address);
+        }
+    }
+}
+
+void PCSampler::report(FILE* file, const SymbolTable* symbols, const size_t limit) const {
+    fprintf(file, "PC samples: %llu, one every %llu cycles\n", (unsigned long long)samples, (unsigned long long)period);
+    if(!samples) return;
+
+    Entry* entries = new Entry[0x10000];
+    size_t count   = 0;
+
+    if(symbols && symbols->count) {
+        // Every address maps to the closest label below it, so functions are totalled in one pass over the symbol index
+        u64* totals = new u64[symbols->count + 1]();
+        for(u32 address = 0; address < 0x10000; address++) {
+            if(!histogram[address]) continue;
+
+            const SymbolTable::Symbol* symbol = symbols->find(static_cast<u16>(address));
+            totals[symbol ? static_cast<size_t>(symbol - symbols->symbols) : symbols->count] += histogram[address];
+        }
+        for(size_t i = 0; i <= symbols->count; i++) {
+            if(totals[i]) {
+                entries[count++] = {totals[i], static_cast<u32>(i)};
+            }
+        }
+        delete[] totals;
+
+        fprintf(file, "Hot functions:\n");
+        print_entries(file, entries, count, limit, samples, symbols, true);
+        count = 0;
+    }
+
+    for(u32 address = 0; address < 0x10000; address++) {
+        if(histogram[address]) {
+            entries[count++] = {histogram[address], address};
+        }
+    }
+
+    fprintf(file, "Hot addresses:\n");
+    print_entries(file, entries, count, limit, samples, symbols, false);
+    delete[] entries;
+}
\ No newline at end of file
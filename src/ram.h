@@ -1,30 +1,610 @@
 #pragma once
+#include "bus_trace.h"
 #include "types.h"
+#include <atomic>
+#include <new>
 #include <stdio.h>
+#include <string.h>
+
+struct MemoryImage;
 
 struct RAM {
     static constexpr size_t MAX_MEMORY = KB(64);
+    static constexpr size_t PAGE_SIZE  = 256;
+    static constexpr size_t PAGE_COUNT = MAX_MEMORY / PAGE_SIZE;
+    static constexpr u16 PAGE_SHIFT    = 8;
+    static constexpr u16 PAGE_MASK     = PAGE_SIZE - 1;
+
+    // Pages are reference counted so that instances can share read-only images; a page is only written in place while its owner holds
+    // the sole reference, otherwise the first write copies it. Pages are carved out of slabs and recycled through a per-thread free
+    // list, so copy-on-write and instance resets stop reaching the general purpose allocator once a harness is warmed up.
+    struct alignas(64) Page {
+        u8 data[PAGE_SIZE];
+        std::atomic<u32> references;
+
+        static void* operator new(size_t size);
+        static void operator delete(void* pointer);
+
+    private:
+        static constexpr size_t SLAB_PAGES = 64;
+
+        struct FreePage {
+            FreePage* next;
+        };
 
-    u16 most_recent_read;
-    u16 most_recent_write;
+        static thread_local FreePage* free_pages;
+        static std::atomic<FreePage*> slabs; // Keeps every slab reachable, including those whose free list belonged to a finished thread
+    };
+
+    static constexpr u8
+        WATCH_READ  = 1 << 0,
+        WATCH_WRITE = 1 << 1;
+
+    using WatchHandler = void (*)(void* context, const u16 address, const u8 value, const u8 kind);
+
+    struct IOHandler {
+        u8 (*read)(void* context, const u16 address);
+        void (*write)(void* context, const u16 address, const u8 data);
+        void* context;
+    };
+
+    RAM() = default;
+    RAM(const RAM&)            = delete;
+    RAM& operator=(const RAM&) = delete;
+    ~RAM();
 
     [[nodiscard]] const u8 read(const u16 address);
     void write(const u16 address, const u8 data);
+    // Reads memory without a bus access: no watchpoints, tracing or I/O handlers, and memory mapped pages read as zero
+    [[nodiscard]] u8 peek(const u16 address) const;
+
+    // Bulk transfers wrap at the end of the address space. Pages on the direct path are copied with memcpy/memset; pages that are
+    // traced or watched fall back to single byte accesses so that every access is still observed.
+    void load_block(const u16 address, const u8* data, const size_t size);
+    void dump_block(const u16 address, u8* data, const size_t size);
+    void fill(const u16 address, const u8 value, const size_t size);
+
+    void attach(const MemoryImage& image);
+    void share(MemoryImage& image);
+    void fork(RAM& child);
+    void release();
+    [[nodiscard]] size_t private_pages() const;
+    [[nodiscard]] const u8* page_data(const u8 index) const; // Null for pages that have never been loaded or written
+
+    [[nodiscard]] static Page* acquire_page(Page* page);
+    static void release_page(Page* page);
+
+    // Dirty page tracking: while enabled, the first write to a page after a clear is routed through write_slow, which marks the page and
+    // re-opens the direct path. Writes to pages that are already dirty (and every write while tracking is disabled) never see the bitmap.
+    // Pages swapped out by attach, fork or release are marked as well.
+    void track_dirty_pages(const bool enabled);
+    [[nodiscard]] bool is_page_dirty(const u8 page) const;
+    [[nodiscard]] size_t dirty_pages(u8 (&pages)[PAGE_COUNT]) const;
+    void clear_dirty_pages();
+    [[nodiscard]] u32 dirty_generation() const;
+    [[nodiscard]] bool tracking_dirty_pages() const;
+
+    // Watchpoints: watching an address takes its whole page off the direct path, and the slow path then checks the exact address. Pages
+    // without watchpoints (and every page while none are set) keep their direct pointers.
+    void watch(const u16 address, const u8 kind);
+    void unwatch(const u16 address, const u8 kind);
+    void set_watch_handler(WatchHandler handler, void* context);
+    void clear_watchpoints(); // Removes every watchpoint and the handler
+
+    // Bus tracing takes every page off the direct path for as long as a trace is attached
+    void attach_trace(BusTrace* bus_trace);
+    [[nodiscard]] BusTrace* attached_trace() const;
+
+    // Memory mapped I/O: pages in the mapped range never get direct pointers and every access to them is forwarded to the handler
+    void map_io(const IOHandler* handler, const u8 first_page, const u8 last_page);
 
     void debug_print() {
-        printf("Ram memory available: %zu\n", sizeof(memory));
+        printf("Ram memory available: %zu (%zu bytes private)\n", MAX_MEMORY, private_pages() * PAGE_SIZE);
     };
 
 private:
-    u8 memory[MAX_MEMORY];
+    struct Watchpoints {
+        u64 addresses[2][MAX_MEMORY / 64]; // Indexed by [is_write][address / 64]
+        u16 per_page[2][PAGE_COUNT];
+        WatchHandler handler;
+        void* context;
+    };
+
+    Page* pages[PAGE_COUNT]        = {}; // A null entry is an untouched page, which reads as zero
+    const u8* read_map[PAGE_COUNT] = {}; // A null entry sends reads from that page through read_slow
+    u8* write_map[PAGE_COUNT]      = {}; // A null entry sends writes to that page through write_slow
+    u64 dirty[PAGE_COUNT / 64]     = {};
+    u32 generation                 = 0;
+    bool dirty_tracking            = false;
+    Watchpoints* watchpoints       = nullptr;
+    BusTrace* trace                = nullptr;
+    const IOHandler* io            = nullptr;
+    u64 io_pages[PAGE_COUNT / 64]  = {};
+
+    static const u8 zero_page[PAGE_SIZE];
+
+    [[nodiscard]] u8 read_slow(const u16 address);
+    void write_slow(const u16 address, const u8 data);
+    [[nodiscard]] u8* writable_page(const u8 index);
+    void mark_dirty(const u8 index);
+    [[nodiscard]] bool direct_page(const u8 index, const bool write) const;
+    [[nodiscard]] bool io_page(const u8 index) const;
+    [[nodiscard]] bool watched(const u16 address, const bool write) const;
+    void watch_hit(const u16 address, const u8 value, const u8 kind) const;
 };
 
+// A memory layout shared read-only between any number of RAM instances. Pages that are never loaded are not stored at all and read
+// as zero in every attached instance.
+struct MemoryImage {
+    RAM::Page* pages[RAM::PAGE_COUNT] = {};
+
+    MemoryImage() = default;
+    MemoryImage(const MemoryImage&)            = delete;
+    MemoryImage& operator=(const MemoryImage&) = delete;
+    ~MemoryImage();
+
+    void load(const u16 address, const u8* data, const size_t size);
+};
+
+const u8 RAM::zero_page[RAM::PAGE_SIZE] = {};
+thread_local RAM::Page::FreePage* RAM::Page::free_pages = nullptr;
+std::atomic<RAM::Page::FreePage*> RAM::Page::slabs{nullptr};
+
+void* RAM::Page::operator new(size_t size) {
+    if(!free_pages) {
+        // The first slot of each slab only links it into the slab list
+        u8* slab       = static_cast<u8*>(::operator new(sizeof(Page) * (SLAB_PAGES + 1), std::align_val_t{alignof(Page)}));
+        FreePage* link = new(slab) FreePage{slabs.load(std::memory_order_relaxed)};
+        while(!slabs.compare_exchange_weak(link->next, link, std::memory_order_release, std::memory_order_relaxed)) {
+        }
+
+        for(size_t i = 1; i <= SLAB_PAGES; i++) {
+            free_pages = new(slab + i * sizeof(Page)) FreePage{free_pages};
+        }
+    }
+
+    FreePage* page = free_pages;
+    free_pages     = page->next;
+    return page;
+}
+
+void RAM::Page::operator delete(void* pointer) {
+    free_pages = new(pointer) FreePage{free_pages};
+}
+
+RAM::~RAM() {
+    release();
+    delete watchpoints;
+}
+
 const u8 RAM::read(const u16 address) {
-    most_recent_read = address;
-    return memory[address];
+    const u8* page = read_map[address >> PAGE_SHIFT];
+    if(page) {
+        return page[address & PAGE_MASK];
+    }
+
+    return read_slow(address);
 }
 
 void RAM::write(const u16 address, const u8 data) {
-    most_recent_write = address;
-    memory[address]   = data;
+    u8* page = write_map[address >> PAGE_SHIFT];
+    if(page) {
+        page[address & PAGE_MASK] = data;
+    } else {
+        write_slow(address, data);
+    }
+}
+
+u8 RAM::read_slow(const u16 address) {
+    const u8 index = address >> PAGE_SHIFT;
+
+    if(io_page(index)) {
+        const u8 value = io->read(io->context, address);
+
+        if(trace) {
+            trace->record(address, value, BusTrace::READ);
+        }
+        if(watchpoints && watched(address, false)) {
+            watch_hit(address, value, WATCH_READ);
+        }
+
+        return value;
+    }
+
+    const u8* page = pages[index] ? pages[index]->data : zero_page;
+    const u8 value = page[address & PAGE_MASK];
+
+    if(trace) {
+        trace->record(address, value, BusTrace::READ);
+    }
+
+    if(watchpoints && watchpoints->per_page[0][index]) {
+        if(watched(address, false)) {
+            watch_hit(address, value, WATCH_READ);
+        }
+    } else if(!trace) {
+        read_map[index] = page;
+    }
+
+    return value;
+}
+
+void RAM::write_slow(const u16 address, const u8 data) {
+    const u8 index = address >> PAGE_SHIFT;
+
+    if(io_page(index)) {
+        io->write(io->context, address, data);
+
+        if(trace) {
+            trace->record(address, data, BusTrace::WRITE);
+        }
+        if(watchpoints && watched(address, true)) {
+            watch_hit(address, data, WATCH_WRITE);
+        }
+
+        return;
+    }
+
+    u8* page = writable_page(index);
+
+    page[address & PAGE_MASK] = data;
+
+    if(trace) {
+        trace->record(address, data, BusTrace::WRITE);
+    }
+
+    if(watchpoints && watchpoints->per_page[1][index]) {
+        if(watched(address, true)) {
+            watch_hit(address, data, WATCH_WRITE);
+        }
+    } else if(!trace) {
+        write_map[index] = page;
+    }
+}
+
+u8* RAM::writable_page(const u8 index) {
+    Page* page = pages[index];
+
+    if(!page || page->references.load(std::memory_order_acquire) > 1) {
+        Page* copy = new Page;
+        copy->references.store(1, std::memory_order_relaxed);
+        memcpy(copy->data, page ? page->data : zero_page, PAGE_SIZE);
+
+        release_page(page);
+        pages[index]    = copy;
+        read_map[index] = nullptr;
+    }
+
+    mark_dirty(index);
+
+    return pages[index]->data;
+}
+
+void RAM::mark_dirty(const u8 index) {
+    if(dirty_tracking) {
+        dirty[index >> 6] |= u64(1) << (index & 63);
+    }
+}
+
+bool RAM::direct_page(const u8 index, const bool write) const {
+    return !trace && !io_page(index) && !(watchpoints && watchpoints->per_page[write][index]);
+}
+
+bool RAM::io_page(const u8 index) const {
+    return (io_pages[index >> 6] >> (index & 63)) & 1;
+}
+
+void RAM::map_io(const IOHandler* handler, const u8 first_page, const u8 last_page) {
+    if(handler) {
+        io = handler;
+    }
+
+    for(size_t i = first_page; i <= last_page; i++) {
+        if(handler) {
+            io_pages[i >> 6] |= u64(1) << (i & 63);
+        } else {
+            io_pages[i >> 6] &= ~(u64(1) << (i & 63));
+        }
+        read_map[i]  = nullptr;
+        write_map[i] = nullptr;
+    }
+}
+
+void RAM::load_block(const u16 address, const u8* data, const size_t size) {
+    size_t offset = 0;
+    while(offset < size) {
+        const u16 target   = static_cast<u16>(address + offset);
+        const u8 index     = target >> PAGE_SHIFT;
+        const size_t start = target & PAGE_MASK;
+        const size_t count = (PAGE_SIZE - start < size - offset) ? PAGE_SIZE - start : size - offset;
+
+        if(direct_page(index, true)) {
+            memcpy(&writable_page(index)[start], &data[offset], count);
+        } else {
+            for(size_t i = 0; i < count; i++) {
+                write(static_cast<u16>(target + i), data[offset + i]);
+            }
+        }
+
+        offset += count;
+    }
+}
+
+void RAM::dump_block(const u16 address, u8* data, const size_t size) {
+    size_t offset = 0;
+    while(offset < size) {
+        const u16 target   = static_cast<u16>(address + offset);
+        const u8 index     = target >> PAGE_SHIFT;
+        const size_t start = target & PAGE_MASK;
+        const size_t count = (PAGE_SIZE - start < size - offset) ? PAGE_SIZE - start : size - offset;
+
+        if(direct_page(index, false)) {
+            memcpy(&data[offset], &(pages[index] ? pages[index]->data : zero_page)[start], count);
+        } else {
+            for(size_t i = 0; i < count; i++) {
+                data[offset + i] = read(static_cast<u16>(target + i));
+            }
+        }
+
+        offset += count;
+    }
+}
+
+void RAM::fill(const u16 address, const u8 value, const size_t size) {
+    size_t offset = 0;
+    while(offset < size) {
+        const u16 target   = static_cast<u16>(address + offset);
+        const u8 index     = target >> PAGE_SHIFT;
+        const size_t start = target & PAGE_MASK;
+        const size_t count = (PAGE_SIZE - start < size - offset) ? PAGE_SIZE - start : size - offset;
+
+        if(direct_page(index, true)) {
+            memset(&writable_page(index)[start], value, count);
+        } else {
+            for(size_t i = 0; i < count; i++) {
+                write(static_cast<u16>(target + i), value);
+            }
+        }
+
+        offset += count;
+    }
+}
+
+RAM::Page* RAM::acquire_page(Page* page) {
+    if(page) {
+        page->references.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return page;
+}
+
+void RAM::release_page(Page* page) {
+    if(page && page->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+        delete page;
+    }
+}
+
+void RAM::attach(const MemoryImage& image) {
+    release();
+
+    for(size_t i = 0; i < PAGE_COUNT; i++) {
+        pages[i] = acquire_page(image.pages[i]);
+        if(pages[i]) {
+            mark_dirty(static_cast<u8>(i));
+        }
+    }
+}
+
+void RAM::share(MemoryImage& image) {
+    // Once shared, our own pages must be copied before they are written again
+    for(size_t i = 0; i < PAGE_COUNT; i++) {
+        Page* previous = image.pages[i];
+        image.pages[i] = acquire_page(pages[i]);
+        release_page(previous);
+        write_map[i] = nullptr;
+    }
+}
+
+void RAM::fork(RAM& child) {
+    // Both sides lose their direct write pointers so that whichever writes a page first takes its own copy
+    for(size_t i = 0; i < PAGE_COUNT; i++) {
+        Page* previous = child.pages[i];
+        child.pages[i] = acquire_page(pages[i]);
+        release_page(previous);
+        if(previous || pages[i]) {
+            child.mark_dirty(static_cast<u8>(i));
+        }
+
+        child.read_map[i]  = nullptr;
+        child.write_map[i] = nullptr;
+        write_map[i]       = nullptr;
+    }
+}
+
+void RAM::release() {
+    // Swapped pages count as written, so that dirty page users do not skip them
+    for(size_t i = 0; i < PAGE_COUNT; i++) {
+        if(pages[i]) {
+            mark_dirty(static_cast<u8>(i));
+        }
+        release_page(pages[i]);
+        pages[i]     = nullptr;
+        read_map[i]  = nullptr;
+        write_map[i] = nullptr;
+    }
+}
+
+u8 RAM::peek(const u16 address) const {
+    const Page* page = pages[address >> PAGE_SHIFT];
+    return page ? page->data[address & PAGE_MASK] : 0x00;
+}
+
+const u8* RAM::page_data(const u8 index) const {
+    return pages[index] ? pages[index]->data : nullptr;
+}
+
+size_t RAM::private_pages() const {
+    size_t count = 0;
+    for(const Page* page : pages) {
+        if(page && page->references.load(std::memory_order_relaxed) == 1) {
+            count++;
+        }
+    }
+
+    return count;
+}
+
+void RAM::track_dirty_pages(const bool enabled) {
+    dirty_tracking = enabled;
+
+    if(enabled) {
+        for(size_t i = 0; i < PAGE_COUNT; i++) {
+            write_map[i] = nullptr;
+        }
+        for(u64& bits : dirty) {
+            bits = 0;
+        }
+        generation++;
+    }
+}
+
+bool RAM::is_page_dirty(const u8 page) const {
+    return (dirty[page >> 6] >> (page & 63)) & 1;
+}
+
+size_t RAM::dirty_pages(u8 (&pages)[PAGE_COUNT]) const {
+    size_t count = 0;
+    for(size_t i = 0; i < PAGE_COUNT; i++) {
+        if(is_page_dirty(static_cast<u8>(i))) {
+            pages[count++] = static_cast<u8>(i);
+        }
+    }
+
+    return count;
+}
+
+void RAM::clear_dirty_pages() {
+    // Only pages that were dirtied have had their direct path re-opened, so only those need protecting again
+    for(size_t i = 0; i < PAGE_COUNT; i++) {
+        if(is_page_dirty(static_cast<u8>(i))) {
+            write_map[i] = nullptr;
+        }
+    }
+    for(u64& bits : dirty) {
+        bits = 0;
+    }
+    generation++;
+}
+
+u32 RAM::dirty_generation() const {
+    return generation;
+}
+
+bool RAM::tracking_dirty_pages() const {
+    return dirty_tracking;
+}
+
+void RAM::watch(const u16 address, const u8 kind) {
+    if(!watchpoints) {
+        watchpoints = new Watchpoints{};
+    }
+
+    const u8 index = address >> PAGE_SHIFT;
+    for(u8 write = 0; write < 2; write++) {
+        if(!(kind & (write ? WATCH_WRITE : WATCH_READ)) || watched(address, write)) continue;
+
+        watchpoints->addresses[write][address >> 6] |= u64(1) << (address & 63);
+        watchpoints->per_page[write][index]++;
+
+        if(write) {
+            write_map[index] = nullptr;
+        } else {
+            read_map[index] = nullptr;
+        }
+    }
+}
+
+void RAM::unwatch(const u16 address, const u8 kind) {
+    if(!watchpoints) return;
+
+    const u8 index = address >> PAGE_SHIFT;
+    for(u8 write = 0; write < 2; write++) {
+        if(!(kind & (write ? WATCH_WRITE : WATCH_READ)) || !watched(address, write)) continue;
+
+        // The page stays on the slow path until its next access, which re-opens the direct path once no watchpoints remain on it
+        watchpoints->addresses[write][address >> 6] &= ~(u64(1) << (address & 63));
+        watchpoints->per_page[write][index]--;
+    }
+}
+
+void RAM::set_watch_handler(WatchHandler handler, void* context) {
+    if(!watchpoints) {
+        watchpoints = new Watchpoints{};
+    }
+
+    watchpoints->handler = handler;
+    watchpoints->context = context;
+}
+
+void RAM::clear_watchpoints() {
+    // Pages left on the slow path re-open their direct pointers on their next access
+    delete watchpoints;
+    watchpoints = nullptr;
+}
+
+void RAM::attach_trace(BusTrace* bus_trace) {
+    trace = bus_trace;
+
+    for(size_t i = 0; i < PAGE_COUNT; i++) {
+        read_map[i]  = nullptr;
+        write_map[i] = nullptr;
+    }
+}
+
+BusTrace* RAM::attached_trace() const {
+    return trace;
+}
+
+bool RAM::watched(const u16 address, const bool write) const {
+    return (watchpoints->addresses[write][address >> 6] >> (address & 63)) & 1;
+}
+
+void RAM::watch_hit(const u16 address, const u8 value, const u8 kind) const {
+    if(watchpoints->handler) {
+        watchpoints->handler(watchpoints->context, address, value, kind);
+    }
+}
+
+MemoryImage::~MemoryImage() {
+    for(RAM::Page* page : pages) {
+        RAM::release_page(page);
+    }
+}
+
+void MemoryImage::load(const u16 address, const u8* data, const size_t size) {
+    size_t offset = 0;
+    while(offset < size && address + offset < RAM::MAX_MEMORY) {
+        const size_t target = address + offset;
+        const size_t index  = target >> RAM::PAGE_SHIFT;
+        const size_t start  = target & RAM::PAGE_MASK;
+        const size_t count  = (RAM::PAGE_SIZE - start < size - offset) ? RAM::PAGE_SIZE - start : size - offset;
+
+        // Pages already handed out to an instance are copied rather than modified underneath it
+        RAM::Page* page = pages[index];
+        if(!page || page->references.load(std::memory_order_acquire) > 1) {
+            RAM::Page* copy = new RAM::Page;
+            copy->references.store(1, std::memory_order_relaxed);
+            if(page) {
+                memcpy(copy->data, page->data, RAM::PAGE_SIZE);
+            } else {
+                memset(copy->data, 0, RAM::PAGE_SIZE);
+            }
+
+            RAM::release_page(page);
+            page = pages[index] = copy;
+        }
+        memcpy(&page->data[start], &data[offset], count);
+
+        offset += count;
+    }
 }
\ No newline at end of file
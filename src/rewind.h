@@ -0,0 +1,302 @@
+#pragma once
+#include "cpu.h"
+#include "ram.h"
+#include "types.h"
+#include <string.h>
+
+// Rewind history. The newest snapshot is kept uncompressed; every older snapshot is stored as the XOR of itself against the snapshot
+// that followed it, run-length encoded per page, so stepping back is one decode of the newest delta. Only pages that may have changed
+// are compared: those RAM reports dirty since the last snapshot (when its dirty tracking belongs to us) plus those rewritten by the
+// last step back. Without dirty information every page is compared, which is slower but still correct.
+struct Rewind {
+    static constexpr size_t PAGE_SIZE  = RAM::PAGE_SIZE;
+    static constexpr size_t PAGE_COUNT = RAM::PAGE_COUNT;
+
+    // Each page delta is a page index followed by (skip, literal count, literal bytes...) runs covering all 256 bytes. The worst case
+    // alternates single changed and unchanged bytes, plus a trailing skip-only run.
+    static constexpr size_t MAX_PAGE_DELTA = 1 + (PAGE_SIZE / 2) * 3 + 2;
+
+    struct Registers {
+        u16 pc;
+        u8 sp;
+        u8 a, x, y, s;
+        u64 cycles;
+    };
+
+    struct Entry {
+        size_t offset;
+        size_t size;
+    };
+
+    static constexpr size_t MAX_ENTRY_SIZE = sizeof(Registers) + sizeof(u16) + PAGE_COUNT * MAX_PAGE_DELTA;
+
+    u8* buffer          = nullptr;
+    size_t capacity     = 0;
+    Entry* entries      = nullptr;
+    size_t max_entries  = 0;
+    size_t first_entry  = 0;
+    size_t entry_count  = 0;
+    size_t write_offset = 0;
+
+    u64 interval      = 0;
+    u64 next_snapshot = 0;
+
+    bool has_current            = false;
+    Registers current_registers = {};
+    u8* current                 = nullptr; // The newest snapshot, uncompressed
+    u64 stale[PAGE_COUNT / 64]  = {};
+    u32 expected_generation     = 0;
+
+    Rewind() = default;
+    Rewind(const Rewind&)            = delete;
+    Rewind& operator=(const Rewind&) = delete;
+    ~Rewind();
+
+    void init(const size_t buffer_size, const size_t snapshot_limit, const u64 snapshot_interval);
+    void shutdown();
+
+    void update(const CPU& cpu, RAM& ram);
+    void push(const CPU& cpu, RAM& ram);
+    [[nodiscard]] bool step_back(CPU& cpu, RAM& ram);
+    [[nodiscard]] size_t snapshots() const;
+    [[nodiscard]] size_t bytes_used() const;
+
+private:
+    [[nodiscard]] bool page_may_differ(const RAM& ram, const size_t page) const;
+    void sync(RAM& ram);
+    void drop_oldest();
+};
+
+Rewind::~Rewind() {
+    shutdown();
+}
+
+void Rewind::init(const size_t buffer_size, const size_t snapshot_limit, const u64 snapshot_interval) {
+    shutdown();
+
+    capacity    = buffer_size < MAX_ENTRY_SIZE ? MAX_ENTRY_SIZE : buffer_size;
+    buffer      = new u8[capacity];
+    max_entries = snapshot_limit > 1 ? snapshot_limit - 1 : 1;
+    entries     = new Entry[max_entries];
+    current     = new u8[RAM::MAX_MEMORY];
+    interval    = snapshot_interval;
+}
+
+void Rewind::shutdown() {
+    delete[] buffer;
+    delete[] entries;
+    delete[] current;
+    buffer        = nullptr;
+    entries       = nullptr;
+    current       = nullptr;
+    capacity      = 0;
+    max_entries   = 0;
+    first_entry   = 0;
+    entry_count   = 0;
+    write_offset  = 0;
+    next_snapshot = 0;
+    has_current   = false;
+}
+
+void Rewind::update(const CPU& cpu, RAM& ram) {
+    if(cpu.cycles >= next_snapshot) {
+        push(cpu, ram);
+        next_snapshot = cpu.cycles + interval;
+    }
+}
+
+bool Rewind::page_may_differ(const RAM& ram, const size_t page) const {
+    const bool dirty_known = ram.tracking_dirty_pages() && ram.dirty_generation() == expected_generation;
+    const bool stale_page  = (stale[page >> 6] >> (page & 63)) & 1;
+
+    return !dirty_known || stale_page || ram.is_page_dirty(static_cast<u8>(page));
+}
+
+void Rewind::sync(RAM& ram) {
+    for(u64& bits : stale) {
+        bits = 0;
+    }
+
+    if(!ram.tracking_dirty_pages()) {
+        ram.track_dirty_pages(true);
+    } else {
+        ram.clear_dirty_pages();
+    }
+    expected_generation = ram.dirty_generation();
+}
+
+void Rewind::drop_oldest() {
+    first_entry = (first_entry + 1) % max_entries;
+    entry_count--;
+}
+
+void Rewind::push(const CPU& cpu, RAM& ram) {
+    const Registers registers = {cpu.pc, cpu.sp, cpu.a, cpu.x, cpu.y, cpu.s, cpu.cycles};
+
+    if(!has_current) {
+        for(size_t page = 0; page < PAGE_COUNT; page++) {
+            const u8* data = ram.page_data(static_cast<u8>(page));
+            if(data) {
+                memcpy(&current[page * PAGE_SIZE], data, PAGE_SIZE);
+            } else {
+                memset(&current[page * PAGE_SIZE], 0, PAGE_SIZE);
+            }
+        }
+
+        current_registers = registers;
+        has_current       = true;
+        sync(ram);
+        return;
+    }
+
+    // Reserve room for the worst case encoding of every page that may have changed, evicting the oldest history it would overwrite
+    size_t reserve = sizeof(Registers) + sizeof(u16);
+    for(size_t page = 0; page < PAGE_COUNT; page++) {
+        reserve += page_may_differ(ram, page) ? MAX_PAGE_DELTA : 0;
+    }
+
+    // History is laid out oldest first from the write offset to the end of the buffer, then from its start, so wrapping retires
+    // everything past the write offset before the overlap check below can see the entries at the start
+    if(write_offset + reserve > capacity) {
+        while(entry_count > 0 && entries[first_entry].offset >= write_offset) {
+            drop_oldest();
+        }
+        write_offset = 0;
+    }
+    while(entry_count > 0) {
+        const Entry& oldest = entries[first_entry];
+        const bool overlaps = oldest.offset < write_offset + reserve && write_offset < oldest.offset + oldest.size;
+        if(!overlaps && entry_count < max_entries) break;
+        drop_oldest();
+    }
+
+    u8* out = &buffer[write_offset];
+    memcpy(out, &current_registers, sizeof(Registers));
+    out += sizeof(Registers);
+
+    u8* page_count_slot = out;
+    u16 page_count      = 0;
+    out += sizeof(u16);
+
+    for(size_t page = 0; page < PAGE_COUNT; page++) {
+        if(!page_may_differ(ram, page)) continue;
+
+        const u8* data = ram.page_data(static_cast<u8>(page));
+        u8* previous   = &current[page * PAGE_SIZE];
+
+        u8* start = out;
+        *out++    = static_cast<u8>(page);
+
+        size_t position = 0;
+        bool changed    = false;
+        while(position < PAGE_SIZE) {
+            size_t skip = 0;
+            while(position + skip < PAGE_SIZE && skip < 255 && previous[position + skip] == (data ? data[position + skip] : 0)) {
+                skip++;
+            }
+            position += skip;
+
+            size_t literal = 0;
+            while(position + literal < PAGE_SIZE && literal < 255 && previous[position + literal] != (data ? data[position + literal] : 0)) {
+                literal++;
+            }
+
+            out[0] = static_cast<u8>(skip);
+            out[1] = static_cast<u8>(literal);
+            out += 2;
+            for(size_t i = 0; i < literal; i++, position++) {
+                const u8 value     = data ? data[position] : 0;
+                *out++             = previous[position] ^ value;
+                previous[position] = value;
+            }
+            changed |= literal > 0;
+        }
+
+        if(changed) {
+            page_count++;
+        } else {
+            out = start;
+        }
+    }
+    memcpy(page_count_slot, &page_count, sizeof(page_count));
+
+    entries[(first_entry + entry_count) % max_entries] = {write_offset, static_cast<size_t>(out - &buffer[write_offset])};
+    entry_count++;
+    write_offset += static_cast<size_t>(out - &buffer[write_offset]);
+
+    current_registers = registers;
+    sync(ram);
+}
+
+bool Rewind::step_back(CPU& cpu, RAM& ram) {
+    if(!has_current) return false;
+
+    // First bring the machine back to the newest snapshot...
+    for(size_t page = 0; page < PAGE_COUNT; page++) {
+        if(page_may_differ(ram, page)) {
+            ram.load_block(static_cast<u16>(page << RAM::PAGE_SHIFT), &current[page * PAGE_SIZE], PAGE_SIZE);
+        }
+    }
+
+    cpu.pc     = current_registers.pc;
+    cpu.sp     = current_registers.sp;
+    cpu.a      = current_registers.a;
+    cpu.x      = current_registers.x;
+    cpu.y      = current_registers.y;
+    cpu.s      = current_registers.s;
+    cpu.cycles = current_registers.cycles;
+    sync(ram);
+
+    // ...then retire it by decoding the newest delta into the uncompressed copy
+    if(entry_count == 0) {
+        has_current = false;
+        return true;
+    }
+
+    const Entry& newest = entries[(first_entry + entry_count - 1) % max_entries];
+    const u8* in        = &buffer[newest.offset];
+
+    memcpy(&current_registers, in, sizeof(Registers));
+    in += sizeof(Registers);
+
+    u16 page_count;
+    memcpy(&page_count, in, sizeof(page_count));
+    in += sizeof(page_count);
+
+    for(u16 i = 0; i < page_count; i++) {
+        const u8 page = *in++;
+        u8* previous  = &current[page * PAGE_SIZE];
+
+        size_t position = 0;
+        while(position < PAGE_SIZE) {
+            position += in[0];
+            const size_t literal = in[1];
+            in += 2;
+
+            for(size_t j = 0; j < literal; j++) {
+                previous[position++] ^= *in++;
+            }
+        }
+
+        stale[page >> 6] |= u64(1) << (page & 63);
+    }
+
+    write_offset = newest.offset;
+    entry_count--;
+    next_snapshot = cpu.cycles + interval;
+
+    return true;
+}
+
+size_t Rewind::snapshots() const {
+    return entry_count + has_current;
+}
+
+size_t Rewind::bytes_used() const {
+    size_t total = 0;
+    for(size_t i = 0; i < entry_count; i++) {
+        total += entries[(first_entry + i) % max_entries].size;
+    }
+
+    return total;
+}
\ No newline at end of file
@@ -0,0 +1,329 @@
+#pragma once
+#include "cpu.h"
+#include "ram.h"
+#include "types.h"
+#include <stddef.h>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+constexpr u32 fourcc(const char (&name)[5]) {
+    return u32(u8(name[0])) | (u32(u8(name[1])) << 8) | (u32(u8(name[2])) << 16) | (u32(u8(name[3])) << 24);
+}
+
+// Save states are a file header followed by tagged, sized chunks. Readers skip chunks they do not recognise and fall back to defaults
+// for chunks that are missing, and every chunk carries its own version so that its layout can grow without breaking older files.
+// All values are stored little endian, which is the native order of every host we build for.
+struct SaveState {
+    static constexpr u32 MAGIC   = fourcc("NESS");
+    static constexpr u16 VERSION = 1;
+
+    static constexpr u32
+        CPU_CHUNK = fourcc("CPU "),
+        RAM_CHUNK = fourcc("RAM ");
+
+    static constexpr u16
+        CPU_CHUNK_VERSION = 1,
+        RAM_CHUNK_VERSION = 1;
+
+    struct FileHeader {
+        u32 magic;
+        u16 version;
+        u16 header_size;
+    };
+
+    struct ChunkHeader {
+        u32 tag;
+        u16 version;
+        u16 reserved;
+        u32 size;
+    };
+
+    struct CPUChunk {
+        u16 pc;
+        u8 sp;
+        u8 a, x, y, s;
+        u8 reserved;
+        u64 cycles;
+    };
+    static_assert(sizeof(CPUChunk) == 16, "The CPU chunk layout is part of the file format");
+
+    // The RAM chunk is a u32 page count followed by that many (u8 index, u8 data[256]) records; pages that were never touched are
+    // omitted and restore as zero.
+    struct Writer {
+        FILE* file       = nullptr;
+        long chunk_start = 0;
+
+        [[nodiscard]] bool open(const char* path);
+        void begin_chunk(const u32 chunk_tag, const u16 version);
+        void write(const void* data, const size_t size);
+        void end_chunk();
+        [[nodiscard]] bool close();
+    };
+
+    struct Reader {
+        const u8* data = nullptr;
+        size_t size    = 0;
+        u16 version    = 0;
+
+#if defined(_WIN32)
+        HANDLE file    = INVALID_HANDLE_VALUE;
+        HANDLE mapping = nullptr;
+#endif
+
+        Reader() = default;
+        Reader(const Reader&)            = delete;
+        Reader& operator=(const Reader&) = delete;
+        ~Reader();
+
+        [[nodiscard]] bool open(const char* path);
+        void close();
+        [[nodiscard]] const u8* find_chunk(const u32 chunk_tag, u16* chunk_version, u32* chunk_size) const;
+    };
+
+    // Chunks are decoded into temporaries and only applied once every chunk of a state has been read, so a corrupt state changes
+    // nothing. Memory is applied by swapping pages, which goes around watchpoints, bus traces and I/O handlers.
+    static void write_cpu(Writer& writer, const CPU& cpu);
+    static void write_ram(Writer& writer, const RAM& ram);
+    [[nodiscard]] static bool read_cpu(const Reader& reader, CPUChunk& chunk);
+    [[nodiscard]] static bool read_ram(const Reader& reader, MemoryImage& image);
+    static void restore_cpu(CPU& cpu, const CPUChunk& chunk);
+
+    [[nodiscard]] static bool save(const char* path, const CPU& cpu, const RAM& ram);
+    [[nodiscard]] static bool load(const char* path, CPU& cpu, RAM& ram);
+};
+
+bool SaveState::Writer::open(const char* path) {
+    file = fopen(path, "wb");
+    if(!file) return false;
+
+    const FileHeader header = {MAGIC, VERSION, sizeof(FileHeader)};
+    fwrite(&header, sizeof(header), 1, file);
+
+    return true;
+}
+
+void SaveState::Writer::begin_chunk(const u32 chunk_tag, const u16 version) {
+    chunk_start = ftell(file);
+
+    const ChunkHeader header = {chunk_tag, version, 0, 0};
+    fwrite(&header, sizeof(header), 1, file);
+}
+
+void SaveState::Writer::write(const void* data, const size_t size) {
+    fwrite(data, 1, size, file);
+}
+
+void SaveState::Writer::end_chunk() {
+    // The size is patched in afterwards so that chunk payloads can be streamed without knowing their length up front
+    const long end = ftell(file);
+    const u32 size = static_cast<u32>(end - chunk_start - static_cast<long>(sizeof(ChunkHeader)));
+
+    fseek(file, chunk_start + static_cast<long>(offsetof(ChunkHeader, size)), SEEK_SET);
+    fwrite(&size, sizeof(size), 1, file);
+    fseek(file, end, SEEK_SET);
+}
+
+bool SaveState::Writer::close() {
+    const bool ok = !ferror(file);
+    return (fclose(file) == 0) && ok;
+}
+
+SaveState::Reader::~Reader() {
+    close();
+}
+
+bool SaveState::Reader::open(const char* path) {
+    close();
+
+#if defined(_WIN32)
+    file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if(file == INVALID_HANDLE_VALUE) return false;
+
+    LARGE_INTEGER file_size;
+    if(!GetFileSizeEx(file, &file_size) || file_size.QuadPart == 0) {
+        close();
+        return false;
+    }
+
+    mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    data    = mapping ? static_cast<const u8*>(MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0)) : nullptr;
+    size    = static_cast<size_t>(file_size.QuadPart);
+#else
+    const int fd = ::open(path, O_RDONLY);
+    if(fd < 0) return false;
+
+    struct stat info;
+    if(fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+
+    void* view = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+
+    data = (view == MAP_FAILED) ? nullptr : static_cast<const u8*>(view);
+    size = static_cast<size_t>(info.st_size);
+#endif
+
+    FileHeader header;
+    if(!data || size < sizeof(header)) {
+        close();
+        return false;
+    }
+
+    memcpy(&header, data, sizeof(header));
+    if(header.magic != MAGIC || header.version > VERSION || header.header_size < sizeof(FileHeader) || header.header_size > size) {
+        close();
+        return false;
+    }
+
+    version = header.version;
+    return true;
+}
+
+void SaveState::Reader::close() {
+#if defined(_WIN32)
+    if(data) UnmapViewOfFile(data);
+    if(mapping) CloseHandle(mapping);
+    if(file != INVALID_HANDLE_VALUE) CloseHandle(file);
+    mapping = nullptr;
+    file    = INVALID_HANDLE_VALUE;
+#else
+    if(data) munmap(const_cast<u8*>(data), size);
+#endif
+
+    data    = nullptr;
+    size    = 0;
+    version = 0;
+}
+
+const u8* SaveState::Reader::find_chunk(const u32 chunk_tag, u16* chunk_version, u32* chunk_size) const {
+    FileHeader file_header;
+    memcpy(&file_header, data, sizeof(file_header));
+
+    size_t offset = file_header.header_size;
+    while(offset + sizeof(ChunkHeader) <= size) {
+        ChunkHeader header;
+        memcpy(&header, &data[offset], sizeof(header));
+        offset += sizeof(header);
+
+        if(header.size > size - offset) break;
+
+        if(header.tag == chunk_tag) {
+            *chunk_version = header.version;
+            *chunk_size    = header.size;
+            return &data[offset];
+        }
+
+        offset += header.size;
+    }
+
+    return nullptr;
+}
+
+void SaveState::write_cpu(Writer& writer, const CPU& cpu) {
+    const CPUChunk chunk = {cpu.pc, cpu.sp, cpu.a, cpu.x, cpu.y, cpu.s, 0, cpu.cycles};
+
+    writer.begin_chunk(CPU_CHUNK, CPU_CHUNK_VERSION);
+    writer.write(&chunk, sizeof(chunk));
+    writer.end_chunk();
+}
+
+void SaveState::write_ram(Writer& writer, const RAM& ram) {
+    u32 page_count = 0;
+    for(size_t i = 0; i < RAM::PAGE_COUNT; i++) {
+        page_count += ram.page_data(static_cast<u8>(i)) != nullptr;
+    }
+
+    writer.begin_chunk(RAM_CHUNK, RAM_CHUNK_VERSION);
+    writer.write(&page_count, sizeof(page_count));
+
+    // Pages are streamed straight out of RAM
+    for(size_t i = 0; i < RAM::PAGE_COUNT; i++) {
+        const u8 index = static_cast<u8>(i);
+        const u8* page = ram.page_data(index);
+        if(!page) continue;
+
+        writer.write(&index, sizeof(index));
+        writer.write(page, RAM::PAGE_SIZE);
+    }
+
+    writer.end_chunk();
+}
+
+bool SaveState::read_cpu(const Reader& reader, CPUChunk& chunk) {
+    u16 version;
+    u32 size;
+    const u8* payload = reader.find_chunk(CPU_CHUNK, &version, &size);
+    if(!payload || version > CPU_CHUNK_VERSION) return false;
+
+    // Older, shorter layouts load with the missing trailing fields zeroed
+    chunk = {};
+    memcpy(&chunk, payload, size < sizeof(chunk) ? size : sizeof(chunk));
+
+    return true;
+}
+
+void SaveState::restore_cpu(CPU& cpu, const CPUChunk& chunk) {
+    cpu.pc     = chunk.pc;
+    cpu.sp     = chunk.sp;
+    cpu.a      = chunk.a;
+    cpu.x      = chunk.x;
+    cpu.y      = chunk.y;
+    cpu.s      = chunk.s;
+    cpu.cycles = chunk.cycles;
+}
+
+bool SaveState::read_ram(const Reader& reader, MemoryImage& image) {
+    static constexpr size_t RECORD_SIZE = 1 + RAM::PAGE_SIZE;
+
+    u16 version;
+    u32 size;
+    const u8* payload = reader.find_chunk(RAM_CHUNK, &version, &size);
+    if(!payload || version > RAM_CHUNK_VERSION || size < sizeof(u32)) return false;
+
+    u32 page_count;
+    memcpy(&page_count, payload, sizeof(page_count));
+    if(page_count > RAM::PAGE_COUNT || size < sizeof(u32) + page_count * RECORD_SIZE) return false;
+
+    const u8* record = payload + sizeof(u32);
+    for(u32 i = 0; i < page_count; i++, record += RECORD_SIZE) {
+        image.load(static_cast<u16>(record[0] << RAM::PAGE_SHIFT), &record[1], RAM::PAGE_SIZE);
+    }
+
+    return true;
+}
+
+bool SaveState::save(const char* path, const CPU& cpu, const RAM& ram) {
+    Writer writer;
+    if(!writer.open(path)) return false;
+
+    write_cpu(writer, cpu);
+    write_ram(writer, ram);
+
+    return writer.close();
+}
+
+bool SaveState::load(const char* path, CPU& cpu, RAM& ram) {
+    Reader reader;
+    if(!reader.open(path)) return false;
+
+    CPUChunk registers;
+    MemoryImage memory;
+    if(!read_cpu(reader, registers) || !read_ram(reader, memory)) return false;
+
+    restore_cpu(cpu, registers);
+    ram.attach(memory);
+    return true;
+}
\ No newline at end of file
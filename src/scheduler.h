@@ -0,0 +1,308 @@
+#pragma once
+#include "topology.h"
+#include "types.h"
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+
+// Work-stealing scheduler for batches of independent items, such as emulator instances. Each item has a home worker (items are split
+// into contiguous ranges) and is queued on that worker's deque, so an instance keeps running on the same thread, and its pages stay in
+// that core's cache, unless its home worker falls behind. Owners take work from the back of their deque and idle workers steal from
+// the front of someone else's. An item can ask to run again, which is how long jobs are cut into time slices: a continuation goes back
+// to its home deque rather than staying with whoever stole it.
+//
+// With a Placement other than NONE, worker threads are pinned to CPUs chosen from the detected Topology. The calling thread is worker
+// 0 and is never pinned. Items that must run on their home worker, such as allocating an instance so that its memory is first touched
+// on the right NUMA node, are run with stealing disabled.
+struct Scheduler {
+    // Runs one slice of an item; returns true when the item needs another slice
+    using Work = bool (*)(void* context, const size_t item, const size_t worker);
+
+    size_t worker_count = 0; // Including the thread that calls run()
+    Placement placement = Placement::NONE;
+    Topology topology;
+
+    Scheduler() = default;
+    Scheduler(const Scheduler&)            = delete;
+    Scheduler& operator=(const Scheduler&) = delete;
+    ~Scheduler();
+
+    // A thread_count of 0 uses one thread per hardware thread. max_items sizes the deques up front; run() grows them for larger batches.
+    void init(const size_t thread_count, const size_t max_items, const Placement worker_placement = Placement::NONE);
+    void shutdown();
+
+    // Blocks until every item has finished; the calling thread works as worker 0
+    void run(const size_t item_count, Work work, void* context, const bool steal = true);
+    [[nodiscard]] size_t home(const size_t item) const;
+
+    [[nodiscard]] u64 total_slices() const;
+    [[nodiscard]] u64 total_steals() const;
+    void debug_print() const;
+
+private:
+    struct alignas(64) Deque {
+        std::atomic<bool> locked;
+        u32* items;
+        size_t mask;
+        size_t front; // Total items ever taken from the front
+        size_t back;  // Total items ever pushed
+        s32 cpu;      // -1 when unpinned
+        s32 node;
+        u64 slices;   // Only written by the owning worker
+        u64 steals;
+
+        void lock();
+        void unlock();
+        void push(const u32 item);
+        [[nodiscard]] bool pop(u32& item);
+        [[nodiscard]] bool steal(u32& item);
+    };
+
+    Deque* deques        = nullptr;
+    size_t capacity      = 0; // Slots in every deque, a power of two
+    std::thread* threads = nullptr;
+    std::mutex mutex;
+    std::condition_variable start;
+    std::condition_variable done;
+    u64 generation = 0;
+    size_t idle    = 0;
+    bool stopping  = false;
+
+    Work job          = nullptr;
+    void* job_context = nullptr;
+    size_t job_items  = 0;
+    bool job_steal    = true;
+    std::atomic<size_t> outstanding;
+
+    void reserve(const size_t max_items);
+    void execute(const size_t worker);
+    void work(const size_t worker);
+};
+
+Scheduler::~Scheduler() {
+    shutdown();
+}
+
+void Scheduler::init(const size_t thread_count, const size_t max_items, const Placement worker_placement) {
+    shutdown();
+
+    placement = worker_placement;
+    if(placement != Placement::NONE && topology.cpu_count == 0) {
+        topology.detect();
+    }
+
+    worker_count = thread_count ? thread_count : std::thread::hardware_concurrency();
+    worker_count = worker_count ? worker_count : 1;
+
+    deques = new Deque[worker_count];
+    for(size_t i = 0; i < worker_count; i++) {
+        deques[i].locked.store(false, std::memory_order_relaxed);
+        deques[i].items  = nullptr;
+        deques[i].front  = deques[i].back = 0;
+        deques[i].node   = -1;
+        deques[i].cpu    = i ? topology.cpu_for(placement, i, deques[i].node) : -1;
+        deques[i].slices = deques[i].steals = 0;
+    }
+    reserve(max_items);
+
+    stopping = false;
+    threads  = new std::thread[worker_count - 1];
+    for(size_t i = 1; i < worker_count; i++) {
+        threads[i - 1] = std::thread([this, i] { work(i); });
+    }
+}
+
+void Scheduler::shutdown() {
+    if(!deques) return;
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+    }
+    start.notify_all();
+
+    for(size_t i = 1; i < worker_count; i++) {
+        threads[i - 1].join();
+    }
+    delete[] threads;
+    threads = nullptr;
+
+    for(size_t i = 0; i < worker_count; i++) {
+        delete[] deques[i].items;
+    }
+    delete[] deques;
+    deques       = nullptr;
+    capacity     = 0;
+    worker_count = 0;
+}
+
+// Only called while every worker is idle, when all the deques are empty
+void Scheduler::reserve(const size_t max_items) {
+    if(capacity >= max_items && capacity > 0) return;
+
+    capacity = capacity ? capacity : 1;
+    while(capacity < max_items) {
+        capacity <<= 1;
+    }
+
+    for(size_t i = 0; i < worker_count; i++) {
+        delete[] deques[i].items;
+        deques[i].items = new u32[capacity];
+        deques[i].mask  = capacity - 1;
+    }
+}
+
+void Scheduler::run(const size_t item_count, Work work, void* context, const bool steal) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        job         = work;
+        job_context = context;
+        job_items   = item_count;
+        job_steal   = steal;
+        idle        = 0;
+        outstanding.store(item_count, std::memory_order_relaxed);
+
+        // Any one deque can hold every item, as when there is a single worker
+        reserve(item_count);
+        for(size_t i = 0; i < item_count; i++) {
+            deques[home(i)].push(static_cast<u32>(i));
+        }
+        generation++;
+    }
+    start.notify_all();
+
+    execute(0);
+
+    std::unique_lock<std::mutex> lock(mutex);
+    done.wait(lock, [this] { return idle == worker_count - 1; });
+}
+
+size_t Scheduler::home(const size_t item) const {
+    return item * worker_count / job_items;
+}
+
+u64 Scheduler::total_slices() const {
+    u64 total = 0;
+    for(size_t i = 0; i < worker_count; i++) {
+        total += deques[i].slices;
+    }
+
+    return total;
+}
+
+u64 Scheduler::total_steals() const {
+    u64 total = 0;
+    for(size_t i = 0; i < worker_count; i++) {
+        total += deques[i].steals;
+    }
+
+    return total;
+}
+
+void Scheduler::debug_print() const {
+    static const char* const placements[] = {"none", "compact", "scatter"};
+
+    printf("Scheduler: %zu workers, placement %s\n", worker_count, placements[static_cast<size_t>(placement)]);
+    if(placement != Placement::NONE) {
+        topology.debug_print();
+    }
+    for(size_t i = 0; i < worker_count; i++) {
+        const Deque& deque = deques[i];
+        printf("  worker %zu: cpu %d node %d slices %llu steals %llu\n", i, deque.cpu, deque.node, (unsigned long long)deque.slices,
+               (unsigned long long)deque.steals);
+    }
+}
+
+void Scheduler::execute(const size_t worker) {
+    u32 seed = static_cast<u32>(worker) * 0x9E3779B9u + 1;
+
+    while(outstanding.load(std::memory_order_acquire) > 0) {
+        u32 item;
+        bool found = deques[worker].pop(item);
+
+        // Victims are probed from a random start so that thieves spread out instead of all draining the same deque
+        for(size_t i = 0; !found && job_steal && i < worker_count; i++) {
+            seed ^= seed << 13;
+            seed ^= seed >> 17;
+            seed ^= seed << 5;
+            const size_t victim = (seed + i) % worker_count;
+            if(victim != worker && deques[victim].steal(item)) {
+                found = true;
+                deques[worker].steals++;
+            }
+        }
+
+        if(!found) {
+            std::this_thread::yield();
+            continue;
+        }
+
+        deques[worker].slices++;
+        if(job(job_context, item, worker)) {
+            deques[home(item)].push(item);
+        } else {
+            outstanding.fetch_sub(1, std::memory_order_acq_rel);
+        }
+    }
+}
+
+void Scheduler::work(const size_t worker) {
+    Topology::pin_current_thread(deques[worker].cpu);
+
+    u64 seen = 0;
+    for(;;) {
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            start.wait(lock, [this, seen] { return stopping || generation != seen; });
+            if(stopping) return;
+            seen = generation;
+        }
+
+        execute(worker);
+
+        std::lock_guard<std::mutex> lock(mutex);
+        if(++idle == worker_count - 1) {
+            done.notify_one();
+        }
+    }
+}
+
+void Scheduler::Deque::lock() {
+    while(locked.exchange(true, std::memory_order_acquire)) {
+        while(locked.load(std::memory_order_relaxed)) {
+        }
+    }
+}
+
+void Scheduler::Deque::unlock() {
+    locked.store(false, std::memory_order_release);
+}
+
+void Scheduler::Deque::push(const u32 item) {
+    lock();
+    items[back++ & mask] = item;
+    unlock();
+}
+
+bool Scheduler::Deque::pop(u32& item) {
+    lock();
+    const bool found = back != front;
+    if(found) {
+        item = items[--back & mask];
+    }
+    unlock();
+
+    return found;
+}
+
+bool Scheduler::Deque::steal(u32& item) {
+    lock();
+    const bool found = back != front;
+    if(found) {
+        item = items[front++ & mask];
+    }
+    unlock();
+
+    return found;
+}
\ No newline at end of file
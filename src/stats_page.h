@@ -0,0 +1,269 @@
+#pragma once
+#include "save_state.h"
+#include "types.h"
+#include <atomic>
+#include <chrono>
+#include <stdio.h>
+#include <string.h>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <fcntl.h>
+    #include <sys/mman.h>
+    #include <sys/stat.h>
+    #include <unistd.h>
+#endif
+
+// Live counters in a named shared memory page, so monitoring tools can watch a running emulator without pausing or signalling it.
+// The page is a fixed header followed by one row per instance. The runner publishes once per frame or slice under a sequence lock:
+// the sequence is odd while an update is in progress, and a reader retries any copy that did not start and end on the same even
+// sequence. The publisher never waits on readers, and readers map the page read-only.
+//
+// Shared memory names are POSIX shm names without the leading slash, or Windows file mapping names.
+struct StatsPage {
+    static constexpr u32 MAGIC          = fourcc("NSTA");
+    static constexpr u16 VERSION        = 1;
+    static constexpr double CPU_CLOCK   = 1789773.0; // NTSC CPU cycles per second
+    static constexpr size_t NAME_LENGTH = 64;
+
+    struct Instance {
+        u64 cycles;
+        u64 instructions;
+        u64 frames;
+    };
+
+    struct Totals {
+        u64 updates;
+        u64 elapsed_ns; // Since the page was created
+        u64 cycles;
+        u64 instructions;
+        u64 frames;
+        double mips;              // Guest instructions per second over the last update, in millions
+        double speed;             // Emulated seconds per real second, summed over every instance
+        double frames_per_second; // Summed over every instance
+        u32 instance_count;
+        u32 reserved;
+    };
+
+    struct Header {
+        u32 magic;
+        u16 version;
+        u16 header_size;
+        u32 instance_capacity;
+        u32 reserved;
+        std::atomic<u64> sequence;
+        Totals totals;
+    };
+
+    Header* header      = nullptr;
+    Instance* instances = nullptr; // Rows follow the header in the mapping
+    size_t size         = 0;
+    bool owner          = false;
+
+    StatsPage() = default;
+    StatsPage(const StatsPage&)            = delete;
+    StatsPage& operator=(const StatsPage&) = delete;
+    ~StatsPage();
+
+    // Creates the page for publishing. Any page left behind under the same name is replaced.
+    [[nodiscard]] bool create(const char* name, const u32 instance_capacity);
+    // Maps an existing page for reading
+    [[nodiscard]] bool open(const char* name);
+    void close();
+
+    // Returns the rows to fill for count instances, clamped to the capacity, and holds the sequence odd until end_update
+    [[nodiscard]] Instance* begin_update(const u32 count);
+    // Totals the rows and works out the rates since the previous update
+    void end_update();
+
+    // Copies a consistent set of totals and up to capacity rows. Fails if the publisher stayed mid-update for every attempt.
+    [[nodiscard]] bool read(Totals& totals, Instance* rows, const u32 capacity, const u32 attempts = 1000) const;
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Clock::time_point started;
+    Clock::time_point last_update;
+    Totals last = {};
+    char shared_name[NAME_LENGTH + 2];
+#if defined(_WIN32)
+    HANDLE mapping = nullptr;
+#endif
+
+    [[nodiscard]] bool set_name(const char* name);
+    [[nodiscard]] static double per_second(const u64 now, const u64 before, const double seconds);
+};
+
+StatsPage::~StatsPage() {
+    close();
+}
+
+bool StatsPage::set_name(const char* name) {
+    if(strlen(name) > NAME_LENGTH) return false;
+
+#if defined(_WIN32)
+    snprintf(shared_name, sizeof(shared_name), "%s", name);
+#else
+    snprintf(shared_name, sizeof(shared_name), "/%s", name);
+#endif
+    return true;
+}
+
+bool StatsPage::create(const char* name, const u32 instance_capacity) {
+    close();
+    if(!set_name(name)) return false;
+
+    size = sizeof(Header) + instance_capacity * sizeof(Instance);
+
+#if defined(_WIN32)
+    mapping = CreateFileMappingA(INVALID_HANDLE_VALUE, nullptr, PAGE_READWRITE, 0, static_cast<DWORD>(size), shared_name);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_ALL_ACCESS, 0, 0, size) : nullptr;
+#else
+    shm_unlink(shared_name);
+    const int fd = shm_open(shared_name, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if(fd < 0) return false;
+
+    void* view = ftruncate(fd, static_cast<off_t>(size)) == 0 ? mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0) : MAP_FAILED;
+    ::close(fd);
+    if(view == MAP_FAILED) {
+        view = nullptr;
+    }
+#endif
+
+    owner = true;
+    if(!view) {
+        close();
+        return false;
+    }
+
+    header    = static_cast<Header*>(view);
+    instances = reinterpret_cast<Instance*>(header + 1);
+    memset(static_cast<void*>(view), 0, size);
+
+    header->version           = VERSION;
+    header->header_size       = sizeof(Header);
+    header->instance_capacity = instance_capacity;
+    header->sequence.store(0, std::memory_order_relaxed);
+
+    // Readers check the magic first, so it is stored last
+    std::atomic_thread_fence(std::memory_order_release);
+    header->magic = MAGIC;
+
+    started     = Clock::now();
+    last_update = started;
+    last        = {};
+    return true;
+}
+
+bool StatsPage::open(const char* name) {
+    close();
+    if(!set_name(name)) return false;
+
+#if defined(_WIN32)
+    mapping    = OpenFileMappingA(FILE_MAP_READ, FALSE, shared_name);
+    void* view = mapping ? MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0) : nullptr;
+    if(view) {
+        MEMORY_BASIC_INFORMATION info;
+        size = VirtualQuery(view, &info, sizeof(info)) ? info.RegionSize : 0;
+    }
+#else
+    const int fd = shm_open(shared_name, O_RDONLY, 0);
+    if(fd < 0) return false;
+
+    struct stat info;
+    void* view = MAP_FAILED;
+    if(fstat(fd, &info) == 0 && info.st_size > 0) {
+        size = static_cast<size_t>(info.st_size);
+        view = mmap(nullptr, size, PROT_READ, MAP_SHARED, fd, 0);
+    }
+    ::close(fd);
+    if(view == MAP_FAILED) {
+        view = nullptr;
+    }
+#endif
+
+    header = static_cast<Header*>(view);
+    if(!header || size < sizeof(Header) || header->magic != MAGIC || header->version != VERSION || header->header_size != sizeof(Header) ||
+       size < sizeof(Header) + header->instance_capacity * sizeof(Instance)) {
+        close();
+        return false;
+    }
+
+    instances = reinterpret_cast<Instance*>(header + 1);
+    return true;
+}
+
+void StatsPage::close() {
+#if defined(_WIN32)
+    if(header) UnmapViewOfFile(header);
+    if(mapping) CloseHandle(mapping);
+    mapping = nullptr;
+#else
+    if(header) munmap(header, size);
+    if(owner) shm_unlink(shared_name);
+#endif
+
+    header    = nullptr;
+    instances = nullptr;
+    size      = 0;
+    owner     = false;
+}
+
+StatsPage::Instance* StatsPage::begin_update(const u32 count) {
+    const u64 sequence = header->sequence.load(std::memory_order_relaxed);
+    header->sequence.store(sequence + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    header->totals.instance_count = count < header->instance_capacity ? count : header->instance_capacity;
+    return instances;
+}
+
+double StatsPage::per_second(const u64 now, const u64 before, const double seconds) {
+    // Counts go backwards when the runner is reinitialised or an instance loads a snapshot
+    return now > before && seconds > 0.0 ? static_cast<double>(now - before) / seconds : 0.0;
+}
+
+void StatsPage::end_update() {
+    Totals& totals = header->totals;
+    const auto now = Clock::now();
+
+    totals.cycles       = 0;
+    totals.instructions = 0;
+    totals.frames       = 0;
+    for(u32 i = 0; i < totals.instance_count; i++) {
+        totals.cycles += instances[i].cycles;
+        totals.instructions += instances[i].instructions;
+        totals.frames += instances[i].frames;
+    }
+
+    const double seconds     = std::chrono::duration<double>(now - last_update).count();
+    totals.updates           = last.updates + 1;
+    totals.elapsed_ns        = static_cast<u64>(std::chrono::duration_cast<std::chrono::nanoseconds>(now - started).count());
+    totals.mips              = per_second(totals.instructions, last.instructions, seconds) / 1e6;
+    totals.speed             = per_second(totals.cycles, last.cycles, seconds) / CPU_CLOCK;
+    totals.frames_per_second = per_second(totals.frames, last.frames, seconds);
+
+    last        = totals;
+    last_update = now;
+    header->sequence.store(header->sequence.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+}
+
+bool StatsPage::read(Totals& totals, Instance* rows, const u32 capacity, const u32 attempts) const {
+    for(u32 attempt = 0; attempt < attempts; attempt++) {
+        const u64 before = header->sequence.load(std::memory_order_acquire);
+        if(before & 1) continue;
+
+        memcpy(&totals, &header->totals, sizeof(Totals));
+        const u32 count = totals.instance_count < capacity ? totals.instance_count : capacity;
+        if(rows && count <= header->instance_capacity) {
+            memcpy(rows, instances, count * sizeof(Instance));
+        }
+
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if(header->sequence.load(std::memory_order_relaxed) == before) return true;
+    }
+    return false;
+}
\ No newline at end of file
@@ -0,0 +1,238 @@
+#pragma once
+#include "types.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Labels for guest addresses, loaded from ld65 output: debug info files written with --dbgfile (*.dbg), or VICE label files written
+// with -Ln ("al 00C000 .reset"). Plain "C000 reset" lines are accepted as well. Names are kept in one string pool, so a table with
+// thousands of labels costs two allocations. Only the CPU address is kept; bank numbers are ignored while only mapper 0 is supported.
+struct SymbolTable {
+    struct Symbol {
+        u16 address;
+        u32 name; // Offset into the string pool
+    };
+
+    Symbol* symbols    = nullptr;
+    size_t count       = 0;
+    size_t capacity    = 0;
+    char* names        = nullptr;
+    size_t names_used  = 0;
+    size_t names_space = 0;
+
+    SymbolTable() = default;
+    SymbolTable(const SymbolTable&)            = delete;
+    SymbolTable& operator=(const SymbolTable&) = delete;
+    ~SymbolTable();
+
+    void clear();
+    void add(const u16 address, const char* name, const size_t length);
+    void sort();
+
+    // Appends to the table and sorts it, so several files can be loaded into one table
+    [[nodiscard]] bool load(const char* path);
+    void parse(const char* text, const size_t size, const bool debug_info);
+
+    // The label at an address, or the closest label below it. Labels sharing an address resolve to the first one loaded.
+    [[nodiscard]] const Symbol* find(const u16 address) const;
+    [[nodiscard]] const Symbol* exact(const u16 address) const;
+    [[nodiscard]] const char* name(const Symbol& symbol) const;
+
+private:
+    void parse_debug_line(const char* line, const char* end);
+    void parse_label_line(const char* line, const char* end);
+    static long read_hex(const char*& cursor, const char* end);
+    static int compare(const void* left, const void* right);
+};
+
+SymbolTable::~SymbolTable() {
+    clear();
+}
+
+void SymbolTable::clear() {
+    free(symbols);
+    free(names);
+    symbols     = nullptr;
+    names       = nullptr;
+    count       = 0;
+    capacity    = 0;
+    names_used  = 0;
+    names_space = 0;
+}
+
+void SymbolTable::add(const u16 address, const char* name, const size_t length) {
+    if(count == capacity) {
+        capacity = capacity ? capacity * 2 : 256;
+        symbols  = static_cast<Symbol*>(realloc(symbols, capacity * sizeof(Symbol)));
+    }
+
+    if(names_used + length + 1 > names_space) {
+        while(names_used + length + 1 > names_space) {
+            names_space = names_space ? names_space * 2 : KB(4);
+        }
+        names = static_cast<char*>(realloc(names, names_space));
+    }
+
+    memcpy(&names[names_used], name, length);
+    names[names_used + length] = '\0';
+    symbols[count++]           = {address, static_cast<u32>(names_used)};
+    names_used += length + 1;
+}
+
+int SymbolTable::compare(const void* left, const void* right) {
+    const Symbol* a = static_cast<const Symbol*>(left);
+    const Symbol* b = static_cast<const Symbol*>(right);
+
+    // Names are pooled in load order, so the pool offset keeps labels at the same address in the order they were loaded
+    if(a->address != b->address) return a->address < b->address ? -1 : 1;
+    return a->name < b->name ? -1 : (a->name > b->name ? 1 : 0);
+}
+
+void SymbolTable::sort() {
+    if(count) {
+        qsort(symbols, count, sizeof(Symbol), compare);
+    }
+}
+
+bool SymbolTable::load(const char* path) {
+    FILE* file = fopen(path, "rb");
+    if(!file) return false;
+
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    char* text        = static_cast<char*>(malloc(size > 0 ? static_cast<size_t>(size) : 1));
+    const size_t read = size > 0 ? fread(text, 1, static_cast<size_t>(size), file) : 0;
+    fclose(file);
+
+    const size_t length = strlen(path);
+    parse(text, read, length >= 4 && strcmp(&path[length - 4], ".dbg") == 0);
+    free(text);
+
+    return read == static_cast<size_t>(size > 0 ? size : 0);
+}
+
+void SymbolTable::parse(const char* text, const size_t size, const bool debug_info) {
+    const char* cursor = text;
+    const char* end    = text + size;
+    while(cursor < end) {
+        const char* newline  = static_cast<const char*>(memchr(cursor, '\n', static_cast<size_t>(end - cursor)));
+        const char* line_end = newline ? newline : end;
+        const char* trimmed  = line_end > cursor && line_end[-1] == '\r' ? line_end - 1 : line_end;
+
+        if(debug_info) {
+            parse_debug_line(cursor, trimmed);
+        } else {
+            parse_label_line(cursor, trimmed);
+        }
+        cursor = line_end + 1;
+    }
+
+    sort();
+}
+
+// sym	id=12,name="reset",addrsize=absolute,scope=0,def=40,ref=52,val=0xC000,seg=2,type=lab
+void SymbolTable::parse_debug_line(const char* line, const char* end) {
+    if(end - line < 4 || memcmp(line, "sym\t", 4) != 0) return;
+
+    const char* name   = nullptr;
+    size_t name_length = 0;
+    long value         = -1;
+    bool label         = false;
+    bool local         = false;
+
+    const char* field = line + 4;
+    while(field < end) {
+        const char* comma = static_cast<const char*>(memchr(field, ',', static_cast<size_t>(end - field)));
+        const char* stop  = comma ? comma : end;
+
+        if(stop - field > 6 && memcmp(field, "name=\"", 6) == 0) {
+            name        = field + 6;
+            name_length = static_cast<size_t>(stop - name - (stop[-1] == '"' ? 1 : 0));
+        } else if(stop - field > 4 && memcmp(field, "val=", 4) == 0) {
+            const char* digits = field + 4;
+            if(stop - digits > 2 && digits[0] == '0' && (digits[1] == 'x' || digits[1] == 'X')) {
+                digits += 2;
+            }
+            value = read_hex(digits, stop);
+        } else if(stop - field == 8 && memcmp(field, "type=lab", 8) == 0) {
+            label = true;
+        } else if(stop - field > 7 && memcmp(field, "parent=", 7) == 0) {
+            local = true; // Cheap local labels (@loop) belong to the label before them
+        }
+
+        field = stop + 1;
+    }
+
+    if(name && label && !local && value >= 0 && value <= 0xFFFF) {
+        add(static_cast<u16>(value), name, name_length);
+    }
+}
+
+// al 00C000 .reset, or C000 reset
+void SymbolTable::parse_label_line(const char* line, const char* end) {
+    if(end - line > 3 && memcmp(line, "al ", 3) == 0) {
+        line += 3;
+    }
+
+    const char* name = line;
+    const long value = read_hex(name, end);
+    if(value < 0) return;
+
+    while(name < end && (*name == ' ' || *name == '\t' || *name == '.')) {
+        name++;
+    }
+    const char* name_end = name;
+    while(name_end < end && *name_end != ' ' && *name_end != '\t') {
+        name_end++;
+    }
+
+    if(name_end > name) {
+        add(static_cast<u16>(value & 0xFFFF), name, static_cast<size_t>(name_end - name));
+    }
+}
+
+// Reads hex digits up to the end of the line, since the text is not terminated. Returns -1 when there are none.
+long SymbolTable::read_hex(const char*& cursor, const char* end) {
+    long value         = -1;
+    const char* digits = cursor;
+    while(cursor < end && cursor - digits < 8) {
+        const char c    = *cursor;
+        const int digit = c >= '0' && c <= '9' ? c - '0' : (c >= 'A' && c <= 'F' ? c - 'A' + 10 : (c >= 'a' && c <= 'f' ? c - 'a' + 10 : -1));
+        if(digit < 0) break;
+
+        value = (value < 0 ? 0 : value * 16) + digit;
+        cursor++;
+    }
+    return value;
+}
+
+const SymbolTable::Symbol* SymbolTable::find(const u16 address) const {
+    size_t low  = 0;
+    size_t high = count;
+    while(low < high) {
+        const size_t middle = (low + high) / 2;
+        if(symbols[middle].address <= address) {
+            low = middle + 1;
+        } else {
+            high = middle;
+        }
+    }
+    if(low == 0) return nullptr;
+
+    size_t index = low - 1;
+    while(index > 0 && symbols[index - 1].address == symbols[index].address) {
+        index--;
+    }
+    return &symbols[index];
+}
+
+const SymbolTable::Symbol* SymbolTable::exact(const u16 address) const {
+    const Symbol* symbol = find(address);
+    return symbol && symbol->address == address ? symbol : nullptr;
+}
+
+const char* SymbolTable::name(const Symbol& symbol) const {
+    return &names[symbol.name];
+}
\ No newline at end of file
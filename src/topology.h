@@ -0,0 +1,133 @@
+#pragma once
+#include "types.h"
+#include <stdio.h>
+#include <thread>
+
+#if defined(_WIN32)
+    #define WIN32_LEAN_AND_MEAN
+    #define NOMINMAX
+    #include <windows.h>
+#else
+    #include <pthread.h>
+    #include <sched.h>
+#endif
+
+// Where worker threads go. COMPACT fills the cores of one NUMA node before moving to the next, which keeps a small job on one socket;
+// SCATTER deals workers round robin across nodes, which spreads memory bandwidth over every socket. NONE leaves placement to the OS.
+enum class Placement : u8 {
+    NONE,
+    COMPACT,
+    SCATTER,
+};
+
+// Logical CPUs grouped by NUMA node. On Linux the layout comes from sysfs; elsewhere, or when sysfs is unavailable, every CPU is
+// reported on a single node.
+struct Topology {
+    static constexpr size_t MAX_CPUS  = 1024;
+    static constexpr size_t MAX_NODES = 64;
+
+    u16 cpus[MAX_CPUS];          // Logical CPU ids, ordered by node
+    u16 nodes[MAX_CPUS];         // Node of each entry in cpus
+    u16 node_first[MAX_NODES];   // Index into cpus of each node's first CPU
+    u16 node_size[MAX_NODES];
+    size_t cpu_count  = 0;
+    size_t node_count = 0;
+
+    void detect();
+    // Chooses a CPU for worker; returns -1 under Placement::NONE
+    [[nodiscard]] s32 cpu_for(const Placement placement, const size_t worker, s32& node) const;
+    static bool pin_current_thread(const s32 cpu);
+    void debug_print() const;
+
+private:
+    void add_cpu(const u16 cpu, const u16 node);
+};
+
+void Topology::detect() {
+    cpu_count  = 0;
+    node_count = 0;
+
+#if !defined(_WIN32)
+    for(size_t node = 0; node < MAX_NODES; node++) {
+        char path[64];
+        snprintf(path, sizeof(path), "/sys/devices/system/node/node%zu/cpulist", node);
+
+        FILE* file = fopen(path, "r");
+        if(!file) continue;
+
+        // A cpulist is a comma separated list of single ids and inclusive ranges, e.g. "0-15,32-47"
+        node_first[node_count] = static_cast<u16>(cpu_count);
+        node_size[node_count]  = 0;
+        unsigned first, last;
+        while(fscanf(file, "%u", &first) == 1) {
+            last = first;
+            if(fgetc(file) == '-') {
+                if(fscanf(file, "%u", &last) != 1) break;
+                fgetc(file);
+            }
+            for(unsigned cpu = first; cpu <= last; cpu++) {
+                add_cpu(static_cast<u16>(cpu), static_cast<u16>(node_count));
+            }
+        }
+        fclose(file);
+
+        if(node_size[node_count]) {
+            node_count++;
+        }
+    }
+#endif
+
+    if(cpu_count == 0) {
+        const unsigned hardware = std::thread::hardware_concurrency();
+        node_first[0]           = 0;
+        node_size[0]            = 0;
+        node_count              = 1;
+        for(unsigned cpu = 0; cpu < (hardware ? hardware : 1); cpu++) {
+            add_cpu(static_cast<u16>(cpu), 0);
+        }
+    }
+}
+
+void Topology::add_cpu(const u16 cpu, const u16 node) {
+    if(cpu_count == MAX_CPUS) return;
+
+    cpus[cpu_count]  = cpu;
+    nodes[cpu_count] = node;
+    cpu_count++;
+    node_size[node]++;
+}
+
+s32 Topology::cpu_for(const Placement placement, const size_t worker, s32& node) const {
+    node = -1;
+    if(placement == Placement::NONE || cpu_count == 0) return -1;
+
+    size_t index = worker % cpu_count;
+    if(placement == Placement::SCATTER) {
+        const size_t target = worker % node_count;
+        index               = node_first[target] + (worker / node_count) % node_size[target];
+    }
+
+    node = nodes[index];
+    return cpus[index];
+}
+
+bool Topology::pin_current_thread(const s32 cpu) {
+    if(cpu < 0) return false;
+
+#if defined(_WIN32)
+    if(cpu >= 64) return false; // Beyond the first processor group
+    return SetThreadAffinityMask(GetCurrentThread(), DWORD_PTR(1) << cpu) != 0;
+#else
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpu, &set);
+    return pthread_setaffinity_np(pthread_self(), sizeof(set), &set) == 0;
+#endif
+}
+
+void Topology::debug_print() const {
+    printf("Topology: %zu CPUs on %zu NUMA nodes\n", cpu_count, node_count);
+    for(size_t node = 0; node < node_count; node++) {
+        printf("  node %zu: %u CPUs, first CPU %u\n", node, node_size[node], cpus[node_first[node]]);
+    }
+}
\ No newline at end of file
@@ -0,0 +1,141 @@
+#pragma once
+#include "types.h"
+#include <stdio.h>
+#include <string.h>
+
+// Compares two instruction logs line by line and stops at the first line that differs. Both files are streamed through large
+// buffers and lines are never copied, so multi-gigabyte logs are compared at close to read speed. CRLF and LF line endings compare
+// equal, since the reference nestest.log uses CRLF.
+struct TraceDiff {
+    static constexpr size_t BUFFER_SIZE = MB(4);
+    static constexpr size_t LINE_SIZE   = 256;
+
+    struct Reader {
+        FILE* file     = nullptr;
+        char* buffer   = nullptr;
+        size_t begin   = 0;
+        size_t end     = 0;
+        bool exhausted = false;
+
+        void open(FILE* source);
+        void close();
+        [[nodiscard]] bool next(const char*& line, size_t& length);
+    };
+
+    size_t columns = SIZE_MAX; // Only the first columns of each line are compared, e.g. 73 to ignore the PPU and cycle counts
+    u64 line       = 0;        // Number of the first differing line, counted from 1, or 0 when the logs match
+    u64 lines      = 0;        // Lines compared
+    char expected_line[LINE_SIZE];
+    char actual_line[LINE_SIZE];
+
+    // Returns true when the logs match. A log that ends early diverges at the first missing line, which is reported as empty.
+    [[nodiscard]] bool compare(FILE* expected, FILE* actual);
+    [[nodiscard]] bool compare(const char* expected_path, const char* actual_path);
+
+private:
+    static void copy_line(char* out, const char* line, const size_t length);
+};
+
+void TraceDiff::Reader::open(FILE* source) {
+    file      = source;
+    buffer    = new char[BUFFER_SIZE];
+    begin     = 0;
+    end       = 0;
+    exhausted = false;
+}
+
+void TraceDiff::Reader::close() {
+    delete[] buffer;
+    buffer = nullptr;
+}
+
+bool TraceDiff::Reader::next(const char*& line, size_t& length) {
+    for(;;) {
+        const char* start   = &buffer[begin];
+        const char* newline = static_cast<const char*>(memchr(start, '\n', end - begin));
+
+        // A line longer than the whole buffer is split rather than failing the comparison
+        if(newline || exhausted || (begin == 0 && end == BUFFER_SIZE)) {
+            if(!newline && begin == end) return false;
+
+            const size_t span = newline ? static_cast<size_t>(newline - start) : end - begin;
+            line              = start;
+            length            = span && start[span - 1] == '\r' ? span - 1 : span;
+            begin += newline ? span + 1 : span;
+            return true;
+        }
+
+        memmove(buffer, start, end - begin);
+        end -= begin;
+        begin = 0;
+
+        const size_t count = fread(&buffer[end], 1, BUFFER_SIZE - end, file);
+        end += count;
+        exhausted = count == 0;
+    }
+}
+
+bool TraceDiff::compare(FILE* expected, FILE* actual) {
+    Reader readers[2];
+    readers[0].open(expected);
+    readers[1].open(actual);
+
+    line             = 0;
+    lines            = 0;
+    expected_line[0] = '\0';
+    actual_line[0]   = '\0';
+
+    for(;;) {
+        const char* expected_text = nullptr;
+        const char* actual_text   = nullptr;
+        size_t expected_length    = 0;
+        size_t actual_length      = 0;
+
+        const bool has_expected = readers[0].next(expected_text, expected_length);
+        const bool has_actual   = readers[1].next(actual_text, actual_length);
+        if(!has_expected && !has_actual) break;
+
+        lines++;
+        expected_length = expected_length < columns ? expected_length : columns;
+        actual_length   = actual_length < columns ? actual_length : columns;
+
+        if(has_expected != has_actual || expected_length != actual_length || memcmp(expected_text, actual_text, expected_length) != 0) {
+            line = lines;
+            copy_line(expected_line, expected_text, expected_length);
+            copy_line(actual_line, actual_text, actual_length);
+            break;
+        }
+    }
+
+    readers[0].close();
+    readers[1].close();
+
+    return line == 0;
+}
+
+bool TraceDiff::compare(const char* expected_path, const char* actual_path) {
+    FILE* expected = fopen(expected_path, "rb");
+    FILE* actual   = fopen(actual_path, "rb");
+
+    bool matched = false;
+    if(expected && actual) {
+        matched = compare(expected, actual);
+    } else {
+        line = 1;
+        copy_line(expected_line, expected ? "" : "<unreadable>", expected ? 0 : 12);
+        copy_line(actual_line, actual ? "" : "<unreadable>", actual ? 0 : 12);
+    }
+
+    if(expected) fclose(expected);
+    if(actual) fclose(actual);
+
+    return matched;
+}
+
+void TraceDiff::copy_line(char* out, const char* line, const size_t length) {
+    const size_t copied = length < LINE_SIZE ? length : LINE_SIZE - 1;
+    if(copied) {
+        memcpy(out, line, copied);
+    }
+    out[copied] = '\0';
+}
\ No newline at end of file
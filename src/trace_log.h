@@ -0,0 +1,265 @@
+#pragma once
+#include "opcodes.h"
+#include "ram.h"
+#include "types.h"
+#include <stdio.h>
+
+// Instruction log in the nestest.log line format, so that runs can be diffed against reference logs:
+//
+//   C000  4C F5 C5  JMP $C5F5                       A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7
+//
+// Each line describes the machine before the instruction executes. Lines are formatted straight into a large buffer that is only
+// written out when it fills, so the cost per instruction is the formatting alone. There is no PPU yet, so the PPU column is derived
+// from the cycle count at three dots per CPU cycle, which matches nestest.log for as long as rendering stays disabled.
+struct TraceLog {
+    struct State {
+        u64 cycle;
+        u16 pc;
+        u8 a, x, y, s, sp;
+    };
+
+    static constexpr size_t BUFFER_SIZE        = MB(1);
+    static constexpr size_t LINE_SIZE          = 128;
+    static constexpr size_t DISASSEMBLY_COLUMN = 16;
+    static constexpr size_t REGISTER_COLUMN    = 48;
+    static constexpr u32 DOTS_PER_SCANLINE     = 341;
+    static constexpr u32 SCANLINES_PER_FRAME   = 262;
+
+    char* buffer      = nullptr;
+    size_t used       = 0;
+    FILE* file        = nullptr;
+    const RAM* memory = nullptr;
+    u64 lines         = 0;
+
+    TraceLog() = default;
+    TraceLog(const TraceLog&)            = delete;
+    TraceLog& operator=(const TraceLog&) = delete;
+    ~TraceLog();
+
+    // Operands are read from ram without going through the bus, so logging never triggers watchpoints or I/O
+    [[nodiscard]] bool open(const char* path, const RAM* ram);
+    void close();
+    void flush();
+
+    void write(const State& state);
+    static size_t format(const RAM& ram, const State& state, char* out);
+};
+
+TraceLog::~TraceLog() {
+    close();
+}
+
+bool TraceLog::open(const char* path, const RAM* ram) {
+    close();
+
+    file = fopen(path, "wb");
+    if(!file) return false;
+
+    buffer = new char[BUFFER_SIZE];
+    used   = 0;
+    memory = ram;
+    lines  = 0;
+
+    return true;
+}
+
+void TraceLog::close() {
+    if(file) {
+        flush();
+        fclose(file);
+        file = nullptr;
+    }
+
+    delete[] buffer;
+    buffer = nullptr;
+}
+
+void TraceLog::flush() {
+    if(!file || !used) return;
+
+    fwrite(buffer, 1, used, file);
+    used = 0;
+}
+
+void TraceLog::write(const State& state) {
+    if(!file) return;
+
+    if(used + LINE_SIZE > BUFFER_SIZE) {
+        flush();
+    }
+
+    used += format(*memory, state, &buffer[used]);
+    lines++;
+}
+
+size_t TraceLog::format(const RAM& ram, const State& state, char* out) {
+    static constexpr char HEX[] = "0123456789ABCDEF";
+
+    char* cursor = out;
+
+    auto hex = [&cursor](const u32 value, const int digits) {
+        for(int shift = (digits - 1) * 4; shift >= 0; shift -= 4) {
+            *cursor++ = HEX[(value >> shift) & 0xF];
+        }
+    };
+    auto text = [&cursor](const char* string) {
+        while(*string) {
+            *cursor++ = *string++;
+        }
+    };
+    auto decimal = [&cursor](u64 value, const int width) {
+        char digits[20];
+        int count = 0;
+        do {
+            digits[count++] = static_cast<char>('0' + value % 10);
+            value /= 10;
+        } while(value);
+        for(int i = count; i < width; i++) {
+            *cursor++ = ' ';
+        }
+        while(count) {
+            *cursor++ = digits[--count];
+        }
+    };
+    auto pad_to = [&cursor, out](const size_t column) {
+        while(cursor < out + column) {
+            *cursor++ = ' ';
+        }
+    };
+    auto peek_word = [&ram](const u16 address, const u16 next) {
+        return static_cast<u16>(ram.peek(address) | (ram.peek(next) << 8));
+    };
+
+    const u8 opcode        = ram.peek(state.pc);
+    const u8 low           = ram.peek(static_cast<u16>(state.pc + 1));
+    const u8 high          = ram.peek(static_cast<u16>(state.pc + 2));
+    const u16 word         = static_cast<u16>(low | (high << 8));
+    const u8 operands[2]   = {low, high};
+    const OpcodeInfo& info = Opcodes::info(opcode);
+    const u8 length        = Opcodes::length(opcode);
+    const bool jumps       = info.mnemonic[0] == 'J';
+
+    hex(state.pc, 4);
+    text("  ");
+    hex(opcode, 2);
+    for(u8 i = 1; i < length; i++) {
+        *cursor++ = ' ';
+        hex(operands[i - 1], 2);
+    }
+    pad_to(DISASSEMBLY_COLUMN - 1);
+    *cursor++ = info.mode == AddressingMode::NONE ? '*' : ' ';
+    text(info.mnemonic);
+
+    switch(info.mode) {
+        case AddressingMode::IMP:
+        case AddressingMode::NONE:
+            break;
+        case AddressingMode::ACC:
+            text(" A");
+            break;
+        case AddressingMode::IMM:
+            text(" #$");
+            hex(low, 2);
+            break;
+        case AddressingMode::ZP:
+            text(" $");
+            hex(low, 2);
+            text(" = ");
+            hex(ram.peek(low), 2);
+            break;
+        case AddressingMode::ZPX:
+        case AddressingMode::ZPY: {
+            const bool by_x    = info.mode == AddressingMode::ZPX;
+            const u8 effective = static_cast<u8>(low + (by_x ? state.x : state.y));
+            text(" $");
+            hex(low, 2);
+            text(by_x ? ",X @ " : ",Y @ ");
+            hex(effective, 2);
+            text(" = ");
+            hex(ram.peek(effective), 2);
+            break;
+        }
+        case AddressingMode::ABS:
+            text(" $");
+            hex(word, 4);
+            if(!jumps) {
+                text(" = ");
+                hex(ram.peek(word), 2);
+            }
+            break;
+        case AddressingMode::ABSX:
+        case AddressingMode::ABSY: {
+            const bool by_x     = info.mode == AddressingMode::ABSX;
+            const u16 effective = static_cast<u16>(word + (by_x ? state.x : state.y));
+            text(" $");
+            hex(word, 4);
+            text(by_x ? ",X @ " : ",Y @ ");
+            hex(effective, 4);
+            text(" = ");
+            hex(ram.peek(effective), 2);
+            break;
+        }
+        case AddressingMode::IND: {
+            // The pointer's high byte is fetched without carrying into the high byte of the pointer address, as on hardware
+            const u16 target = peek_word(word, static_cast<u16>((word & 0xFF00) | ((word + 1) & 0x00FF)));
+            text(" ($");
+            hex(word, 4);
+            text(") = ");
+            hex(target, 4);
+            break;
+        }
+        case AddressingMode::INDX: {
+            const u8 pointer    = static_cast<u8>(low + state.x);
+            const u16 effective = peek_word(pointer, static_cast<u8>(pointer + 1));
+            text(" ($");
+            hex(low, 2);
+            text(",X) @ ");
+            hex(pointer, 2);
+            text(" = ");
+            hex(effective, 4);
+            text(" = ");
+            hex(ram.peek(effective), 2);
+            break;
+        }
+        case AddressingMode::INDY: {
+            const u16 base      = peek_word(low, static_cast<u8>(low + 1));
+            const u16 effective = static_cast<u16>(base + state.y);
+            text(" ($");
+            hex(low, 2);
+            text("),Y = ");
+            hex(base, 4);
+            text(" @ ");
+            hex(effective, 4);
+            text(" = ");
+            hex(ram.peek(effective), 2);
+            break;
+        }
+        case AddressingMode::REL:
+            text(" $");
+            hex(static_cast<u16>(state.pc + 2 + static_cast<s8>(low)), 4);
+            break;
+    }
+
+    const u64 dots = state.cycle * 3;
+
+    pad_to(REGISTER_COLUMN);
+    text("A:");
+    hex(state.a, 2);
+    text(" X:");
+    hex(state.x, 2);
+    text(" Y:");
+    hex(state.y, 2);
+    text(" P:");
+    hex(state.s, 2);
+    text(" SP:");
+    hex(state.sp, 2);
+    text(" PPU:");
+    decimal(dots / DOTS_PER_SCANLINE % SCANLINES_PER_FRAME, 3);
+    *cursor++ = ',';
+    decimal(dots % DOTS_PER_SCANLINE, 3);
+    text(" CYC:");
+    decimal(state.cycle, 0);
+    *cursor++ = '\n';
+
+    return static_cast<size_t>(cursor - out);
+}
\ No newline at end of file
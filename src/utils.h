@@ -8,4 +8,4 @@
         ((byte)&0x08 ? '1' : '0'), \
         ((byte)&0x04 ? '1' : '0'), \
         ((byte)&0x02 ? '1' : '0'), \
-        ((byte)&0x01 ? '1' : '0')
\ No newline at end of file
+        ((byte)&0x01 ? '1' : '0')
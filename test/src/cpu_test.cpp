@@ -1,6 +1,26 @@
+#include "../../src/arena.h"
+#include "../../src/batch.h"
+#include "../../src/breakpoints.h"
+#include "../../src/bus_trace.h"
+#include "../../src/call_graph.h"
+#include "../../src/code_data_log.h"
 #include "../../src/cpu.h"
+#include "../../src/cpu_trace.h"
+#include "../../src/disassembler.h"
+#include "../../src/dma.h"
 #include "../../src/instructions.h"
+#include "../../src/lockstep.h"
+#include "../../src/movie.h"
+#include "../../src/nes.h"
+#include "../../src/opcode_profile.h"
+#include "../../src/pc_sampler.h"
 #include "../../src/ram.h"
+#include "../../src/rewind.h"
+#include "../../src/save_state.h"
+#include "../../src/stats_page.h"
+#include "../../src/symbols.h"
+#include "../../src/trace_diff.h"
+#include "../../src/trace_log.h"
 #include "utest.h"
 
 UTEST_MAIN();
@@ -21,14 +41,20 @@ UTEST_F_TEARDOWN(HardwareFunctionality) {
 struct Instructions {
     CPU cpu;
     RAM ram;
+    BusTrace trace;
 };
 
 UTEST_F_SETUP(Instructions) {
     load_instructions(utest_fixture->cpu);
     utest_fixture->cpu.debug = false;
+
+    utest_fixture->trace.init(64, &utest_fixture->cpu.cycles);
+    utest_fixture->ram.attach_trace(&utest_fixture->trace);
 }
 
 UTEST_F_TEARDOWN(Instructions) {
+    utest_fixture->ram.attach_trace(nullptr);
+    utest_fixture->trace.shutdown();
 }
 
 UTEST_F(HardwareFunctionality, Next_Byte) {
@@ -52,6 +78,1225 @@ UTEST_F(HardwareFunctionality, Next_Word) {
     EXPECT_EQ_MSG(data, 0xAABB, "The two bytes read from memory should equate to 0xAABB as an u16.");
 }
 
+UTEST_F(HardwareFunctionality, Dirty_Pages) {
+    utest_fixture->ram.track_dirty_pages(true);
+    const u32 generation = utest_fixture->ram.dirty_generation();
+
+    utest_fixture->ram.write(0x0010, 0xFF);
+    utest_fixture->ram.write(0x0020, 0xFF);
+    utest_fixture->ram.write(0xAABB, 0xFF);
+
+    u8 pages[RAM::PAGE_COUNT];
+    EXPECT_EQ_MSG(utest_fixture->ram.dirty_pages(pages), 2u, "Only two distinct pages should have been dirtied.");
+    EXPECT_EQ_MSG(pages[0], 0x00, "Page 0x00 should be dirty.");
+    EXPECT_EQ_MSG(pages[1], 0xAA, "Page 0xAA should be dirty.");
+
+    utest_fixture->ram.clear_dirty_pages();
+    EXPECT_FALSE_MSG(utest_fixture->ram.is_page_dirty(0xAA), "Clearing should reset the dirty set.");
+    EXPECT_EQ_MSG(utest_fixture->ram.dirty_generation(), generation + 1, "Clearing should advance the generation.");
+
+    utest_fixture->ram.write(0xAABC, 0xEE);
+    EXPECT_TRUE_MSG(utest_fixture->ram.is_page_dirty(0xAA), "Writing after a clear should dirty the page again.");
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0xAABB), 0xFF, "Earlier writes should be preserved across a clear.");
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0xAABC), 0xEE, "Writes through the slow path should land in memory.");
+}
+
+UTEST_F(HardwareFunctionality, Shared_Memory_Image) {
+    static constexpr u8 program[] = {LDA_IMM, 0x40, NOP};
+
+    MemoryImage image;
+    image.load(0x8000, program, sizeof(program));
+
+    RAM other;
+    utest_fixture->ram.attach(image);
+    other.attach(image);
+
+    EXPECT_EQ_MSG(utest_fixture->ram.private_pages(), 0u, "Attaching an image should not copy any pages.");
+    EXPECT_EQ_MSG(other.read(0x8001), 0x40, "Both instances should read the shared image.");
+
+    utest_fixture->ram.write(0x8001, 0x80);
+
+    EXPECT_EQ_MSG(utest_fixture->ram.private_pages(), 1u, "The first write should copy only the page being written.");
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0x8001), 0x80, "The writer should see its own copy.");
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0x8002), NOP, "The copied page should keep the rest of the image.");
+    EXPECT_EQ_MSG(other.read(0x8001), 0x40, "Other instances should keep seeing the shared image.");
+}
+
+struct WatchLog {
+    u16 address;
+    u8 value;
+    u8 kind;
+    size_t hits;
+};
+
+static void record_watch_hit(void* context, const u16 address, const u8 value, const u8 kind) {
+    WatchLog* log = static_cast<WatchLog*>(context);
+    log->address  = address;
+    log->value    = value;
+    log->kind     = kind;
+    log->hits++;
+}
+
+UTEST_F(HardwareFunctionality, Watchpoints) {
+    WatchLog log = {};
+    utest_fixture->ram.set_watch_handler(record_watch_hit, &log);
+    utest_fixture->ram.watch(0x0300, RAM::WATCH_READ | RAM::WATCH_WRITE);
+
+    utest_fixture->ram.write(0x0301, 0x11);
+    EXPECT_EQ_MSG(log.hits, 0u, "Neighbouring addresses on a watched page should not trigger.");
+
+    utest_fixture->ram.write(0x0300, 0x22);
+    EXPECT_EQ_MSG(log.hits, 1u, "Writing a watched address should trigger.");
+    EXPECT_EQ_MSG(log.kind, RAM::WATCH_WRITE, "The hit should be reported as a write.");
+    EXPECT_EQ_MSG(log.value, 0x22, "The hit should report the written value.");
+
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0x0300), 0x22, "Watched reads should return memory contents.");
+    EXPECT_EQ_MSG(log.hits, 2u, "Reading a watched address should trigger.");
+    EXPECT_EQ_MSG(log.kind, RAM::WATCH_READ, "The hit should be reported as a read.");
+
+    utest_fixture->ram.unwatch(0x0300, RAM::WATCH_READ | RAM::WATCH_WRITE);
+    utest_fixture->ram.write(0x0300, 0x33);
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0x0300), 0x33, "Unwatched addresses should still be readable.");
+    EXPECT_EQ_MSG(log.hits, 2u, "Removed watchpoints should not trigger.");
+}
+
+UTEST_F(Instructions, Bus_Trace_Records) {
+    utest_fixture->cpu.reset();
+
+    utest_fixture->ram.write(0x0000, STA_ZP);
+    utest_fixture->ram.write(0x0001, 0x10);
+
+    utest_fixture->cpu.execute_instructions(utest_fixture->ram);
+
+    BusTrace::Record records[3];
+    ASSERT_EQ_MSG(utest_fixture->trace.recent(records, 3), 3u, "The opcode fetch, operand fetch and store should have been traced.");
+    EXPECT_EQ_MSG(records[0].address, 0x0000, "The opcode should be fetched first.");
+    EXPECT_EQ_MSG(records[0].kind, BusTrace::READ, "The opcode fetch should be a read.");
+    EXPECT_EQ_MSG(records[2].address, 0x0010, "The store should be traced last.");
+    EXPECT_EQ_MSG(records[2].kind, BusTrace::WRITE, "The store should be a write.");
+    EXPECT_EQ_MSG(utest_fixture->cpu.cycles, 3u, "STA_ZP should take 3 cycles.");
+}
+
+UTEST_F(Instructions, CPU_Trace_Stream) {
+    static constexpr const char* path = "cpu_trace_test.txt";
+
+    CPUTrace cpu_trace;
+    cpu_trace.init(16, &utest_fixture->ram);
+    ASSERT_TRUE_MSG(cpu_trace.stream_to(path), "The trace file should open.");
+
+    utest_fixture->cpu.reset();
+    utest_fixture->cpu.debug = true;
+    utest_fixture->cpu.trace = &cpu_trace;
+
+    utest_fixture->ram.write(0x0000, LDA_IMM);
+    utest_fixture->ram.write(0x0001, 0x42);
+    utest_fixture->ram.write(0x0002, TAX);
+
+    utest_fixture->cpu.execute_instructions(utest_fixture->ram, 2);
+    utest_fixture->cpu.trace = nullptr;
+    cpu_trace.stop_stream();
+
+    char lines[2][CPUTrace::LINE_SIZE] = {};
+    FILE* file                         = fopen(path, "rb");
+    ASSERT_TRUE_MSG(file != nullptr, "The trace file should exist.");
+    EXPECT_TRUE_MSG(fgets(lines[0], sizeof(lines[0]), file) != nullptr, "The first instruction should be traced.");
+    EXPECT_TRUE_MSG(fgets(lines[1], sizeof(lines[1]), file) != nullptr, "The second instruction should be traced.");
+    fclose(file);
+    remove(path);
+
+    EXPECT_EQ_MSG(strncmp(lines[0], "0000  A9 42 AA  LDA_IMM", 23), 0, "The first line should hold the PC, bytes and mnemonic.");
+    EXPECT_TRUE_MSG(strstr(lines[1], "A:42 X:42") != nullptr, "The second line should hold the registers after TAX.");
+    EXPECT_TRUE_MSG(strstr(lines[1], "CYC:4") != nullptr, "The second line should hold the cycle count.");
+    EXPECT_EQ_MSG(cpu_trace.dropped.load(), 0u, "Nothing should have been dropped.");
+}
+
+UTEST_F(Instructions, Nestest_Log) {
+    static constexpr const char* path = "nestest_log_test.txt";
+    static constexpr const char* expected[] = {
+        "C000  A2 05     LDX #$05                        A:00 X:00 Y:00 P:24 SP:FD PPU:  0, 21 CYC:7\n",
+        "C002  86 10     STX $10 = 00                    A:00 X:05 Y:00 P:24 SP:FD PPU:  0, 27 CYC:9\n",
+        "C004  BD FB 0F  LDA $0FFB,X @ 1000 = 7E         A:00 X:05 Y:00 P:24 SP:FD PPU:  0, 36 CYC:12\n",
+        "C007  4C 00 C0  JMP $C000                       A:7E X:05 Y:00 P:24 SP:FD PPU:  0, 51 CYC:17\n",
+    };
+    static constexpr u8 program[] = {LDX_IMM, 0x05, STX_ZP, 0x10, LDA_ABSX, 0xFB, 0x0F, JMP_ABS, 0x00, 0xC0};
+
+    TraceLog trace_log;
+    ASSERT_TRUE_MSG(trace_log.open(path, &utest_fixture->ram), "The log file should open.");
+
+    utest_fixture->cpu.reset();
+    utest_fixture->cpu.pc        = 0xC000;
+    utest_fixture->cpu.s         = 0x24;
+    utest_fixture->cpu.sp        = 0xFD;
+    utest_fixture->cpu.cycles    = 7;
+    utest_fixture->cpu.trace_log = &trace_log;
+
+    utest_fixture->ram.load_block(0xC000, program, sizeof(program));
+    utest_fixture->ram.write(0x1000, 0x7E);
+
+    utest_fixture->cpu.execute_instructions(utest_fixture->ram, 4);
+    utest_fixture->cpu.trace_log = nullptr;
+    trace_log.close();
+
+    char line[TraceLog::LINE_SIZE] = {};
+    FILE* file                     = fopen(path, "rb");
+    ASSERT_TRUE_MSG(file != nullptr, "The log file should exist.");
+    for(const char* expected_line : expected) {
+        EXPECT_TRUE_MSG(fgets(line, sizeof(line), file) != nullptr, "Every instruction should be logged.");
+        EXPECT_STREQ(line, expected_line);
+    }
+    EXPECT_TRUE_MSG(fgets(line, sizeof(line), file) == nullptr, "Only the executed instructions should be logged.");
+    fclose(file);
+    remove(path);
+}
+
+UTEST_F(Instructions, Opcode_Profile) {
+    static constexpr const char* path = "opcode_profile_test.csv";
+
+    OpcodeProfile profile;
+    profile.record(LDA_ABSX, 4);
+    profile.record(LDA_ABSX, 5);
+    profile.record(TAX, 2);
+    profile.record(TAX, 2);
+    profile.record(TAX, 2);
+    profile.record(STA_ABS, 520);
+
+#if defined(NES_PROFILE)
+    utest_fixture->cpu.reset();
+    utest_fixture->cpu.profile = &profile;
+    utest_fixture->ram.write(0x0000, TAX);
+    utest_fixture->cpu.execute_instructions(utest_fixture->ram, 1);
+    utest_fixture->cpu.profile = nullptr;
+    profile.counts[TAX][2]--;
+#endif
+
+    EXPECT_EQ(profile.count(LDA_ABSX), 2u);
+    EXPECT_EQ(profile.cycles(LDA_ABSX), 9u);
+    EXPECT_EQ(profile.counts[LDA_ABSX][5], 1u);
+    EXPECT_EQ(profile.count(TAX), 3u);
+    EXPECT_EQ_MSG(profile.counts[STA_ABS][OpcodeProfile::CYCLE_BUCKETS - 1], 1u, "Long executions should share the last bucket.");
+    EXPECT_EQ_MSG(profile.cycles(STA_ABS), 520u, "Long executions should keep their true cycle counts.");
+
+    OpcodeProfile total;
+    total.merge(profile);
+    total.merge(profile);
+    EXPECT_EQ(total.count(TAX), 6u);
+    EXPECT_EQ(total.cycles(STA_ABS), 1040u);
+
+    ASSERT_TRUE_MSG(profile.dump(path), "The profile should be written.");
+
+    char lines[3][256] = {};
+    FILE* file         = fopen(path, "rb");
+    ASSERT_TRUE_MSG(file != nullptr, "The profile file should exist.");
+    for(char* line : lines) {
+        EXPECT_TRUE(fgets(line, sizeof(lines[0]), file) != nullptr);
+    }
+    fclose(file);
+    remove(path);
+
+    EXPECT_EQ_MSG(strncmp(lines[0], "opcode,mnemonic,mode,count,cycles,c0,", 37), 0, "The first line should be the header.");
+    EXPECT_EQ_MSG(strncmp(lines[1], "AA,TAX,IMP,3,6,0,0,3,", 21), 0, "The most frequent opcode should come first.");
+    EXPECT_EQ_MSG(strncmp(lines[2], "BD,LDA,ABSX,2,9,", 16), 0, "Rows should hold the mnemonic and addressing mode.");
+}
+
+UTEST(TraceDiff, First_Divergence) {
+    static constexpr const char* expected_path = "trace_diff_expected.txt";
+    static constexpr const char* actual_path   = "trace_diff_actual.txt";
+
+    auto write_file = [](const char* path, const char* text) {
+        FILE* file = fopen(path, "wb");
+        fputs(text, file);
+        fclose(file);
+    };
+
+    write_file(expected_path, "C000  A2 05  CYC:7\r\nC002  86 10  CYC:9\r\nC004  BD FB  CYC:12\r\n");
+    write_file(actual_path, "C000  A2 05  CYC:7\nC002  86 10  CYC:9\nC004  BD FB  CYC:12");
+
+    TraceDiff diff;
+    EXPECT_TRUE_MSG(diff.compare(expected_path, actual_path), "CRLF and LF logs with the same lines should match.");
+    EXPECT_EQ(diff.lines, 3u);
+
+    write_file(actual_path, "C000  A2 05  CYC:7\nC002  86 10  CYC:8\nC004  BD FB  CYC:11\n");
+    EXPECT_FALSE_MSG(diff.compare(expected_path, actual_path), "The logs should diverge.");
+    EXPECT_EQ(diff.line, 2u);
+    EXPECT_STREQ(diff.expected_line, "C002  86 10  CYC:9");
+    EXPECT_STREQ(diff.actual_line, "C002  86 10  CYC:8");
+
+    diff.columns = 11;
+    EXPECT_TRUE_MSG(diff.compare(expected_path, actual_path), "Columns past the limit should be ignored.");
+
+    write_file(actual_path, "C000  A2 05  CYC:7\n");
+    EXPECT_FALSE_MSG(diff.compare(expected_path, actual_path), "A log that ends early should diverge.");
+    EXPECT_EQ(diff.line, 2u);
+    EXPECT_STREQ(diff.actual_line, "");
+
+    remove(expected_path);
+    remove(actual_path);
+}
+
+UTEST(Disassembler, Instruction_Formats) {
+    static constexpr const char labels[] = "al 00C000 .reset\nal 000010 .pointer\n";
+
+    SymbolTable symbols;
+    symbols.parse(labels, sizeof(labels) - 1, false);
+
+    Disassembler disassembler;
+    char line[Disassembler::LINE_SIZE];
+    auto format = [&](const u8 b0, const u8 b1, const u8 b2, const u16 address) -> const char* {
+        const u8 bytes[3] = {b0, b1, b2};
+        return disassembler.instruction(bytes, address, line) == Opcodes::length(b0) ? line : "wrong length";
+    };
+
+    EXPECT_STREQ(format(JMP_ABS, 0xF5, 0xC5, 0xC000), "C000  4C F5 C5  JMP $C5F5");
+    EXPECT_STREQ(format(LDA_IMM, 0x10, 0x00, 0xC003), "C003  A9 10     LDA #$10");
+    EXPECT_STREQ(format(LDX_ZPY, 0x80, 0x00, 0xC003), "C003  B6 80     LDX $80,Y");
+    EXPECT_STREQ(format(0xB1, 0x10, 0x00, 0xC003), "C003  B1 10     LDA ($10),Y");
+    EXPECT_STREQ(format(0x0A, 0x00, 0x00, 0xC003), "C003  0A        ASL A");
+    EXPECT_STREQ_MSG(format(0xD0, 0xFC, 0x00, 0xC010), "C010  D0 FC     BNE $C00E", "Branch targets should be resolved.");
+    EXPECT_STREQ_MSG(format(0x02, 0x00, 0x00, 0xC003), "C003  02        .byte $02", "Unknown opcodes should be written as data.");
+
+    disassembler.symbols = &symbols;
+    EXPECT_STREQ_MSG(format(JMP_IND, 0x00, 0xC0, 0xC003), "C003  6C 00 C0  JMP (reset)", "Operands on a label should use it.");
+    EXPECT_STREQ(format(STA_ZPX, 0x10, 0x00, 0xC003), "C003  95 10     STA pointer,X");
+    EXPECT_STREQ(format(0x81, 0x10, 0x00, 0xC003), "C003  81 10     STA (pointer,X)");
+}
+
+UTEST(Disassembler, Address_Space) {
+    static constexpr u8 program[]        = {LDX_IMM, 0x00, INC_ABSX, 0x00, 0x03, JMP_ABS, 0x02, 0x80};
+    static constexpr const char labels[] = "al 008002 .loop\nal 008002 .again\n";
+
+    SymbolTable symbols;
+    symbols.parse(labels, sizeof(labels) - 1, false);
+
+    RAM ram;
+    ram.load_block(0x8000, program, sizeof(program));
+    ram.write(0xFFFE, JMP_ABS);
+
+    Disassembler disassembler;
+    disassembler.symbols = &symbols;
+
+    char* listing   = new char[MB(2)];
+    u32 next        = 0;
+    size_t length   = disassembler.disassemble(ram, 0x8000, 0x8008, listing, MB(2), next);
+    listing[length] = '\0';
+    EXPECT_EQ(next, 0x8008u);
+    EXPECT_STREQ(listing, "8000  A2 00     LDX #$00\nloop:\nagain:\n8002  FE 00 03  INC $0300,X\n8005  4C 02 80  JMP loop\n");
+
+    length          = disassembler.disassemble(ram, 0xFFFD, 0x10000, listing, MB(2), next);
+    listing[length] = '\0';
+    EXPECT_STREQ_MSG(listing, "FFFD  00        BRK\nFFFE  4C        .byte $4C\nFFFF  00        BRK\n",
+                     "An instruction cut off by the end of the address space should be written as data.");
+
+    length          = disassembler.disassemble(ram, 0xFFFD, 0x20000, listing, MB(2), next);
+    listing[length] = '\0';
+    EXPECT_EQ_MSG(next, 0x10000u, "Ranges past the address space should be clamped to its end.");
+    EXPECT_STREQ(listing, "FFFD  00        BRK\nFFFE  4C        .byte $4C\nFFFF  00        BRK\n");
+
+    disassembler.disassemble(ram, 0x8000, 0x8004, listing, MB(2), next);
+    EXPECT_EQ_MSG(next, 0x8005u, "An instruction that straddles the end should be decoded whole.");
+
+    // A small buffer ends the listing early, and it carries on from where it stopped
+    size_t total = 0;
+    u32 start    = 0;
+    do {
+        total += disassembler.disassemble(ram, start, 0x10000, listing, 4096, next);
+        start = next;
+    } while(next < 0x10000);
+
+    const size_t whole = disassembler.disassemble(ram, 0, 0x10000, listing, MB(2), next);
+    EXPECT_EQ(next, 0x10000u);
+    EXPECT_EQ_MSG(total, whole, "A listing made in pieces should match one made at once.");
+    delete[] listing;
+}
+
+UTEST_F(Instructions, Cycles_PageCross) {
+    static constexpr size_t instruction_count = 2;
+
+    utest_fixture->cpu.reset();
+
+    utest_fixture->ram.write(0x0000, LDX_IMM);
+    utest_fixture->ram.write(0x0001, 0x01);
+    utest_fixture->ram.write(0x0002, LDA_ABSX);
+    utest_fixture->ram.write(0x0003, 0xFF);
+    utest_fixture->ram.write(0x0004, 0x00);
+
+    utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
+
+    EXPECT_EQ_MSG(utest_fixture->cpu.cycles, 7u, "LDX_IMM takes 2 cycles and a page crossing LDA_ABSX takes 5.");
+}
+
+UTEST_F(HardwareFunctionality, Bulk_Memory) {
+    static constexpr u8 program[] = {LDA_IMM, 0x40, STA_ABS, 0xBB, 0xAA};
+
+    utest_fixture->ram.fill(0x00F0, 0xEE, 0x20);
+    utest_fixture->ram.load_block(0xFFFE, program, sizeof(program));
+
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0x00EF), 0x00, "Filling should not touch memory before the range.");
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0x010F), 0xEE, "Filling should cross page boundaries.");
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0x0110), 0x00, "Filling should not touch memory after the range.");
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0xFFFF), 0x40, "Loading should write from the start address.");
+    EXPECT_EQ_MSG(utest_fixture->ram.read(0x0002), 0xAA, "Loading should wrap at the end of the address space.");
+
+    u8 dump[sizeof(program)];
+    utest_fixture->ram.dump_block(0xFFFE, dump, sizeof(dump));
+    EXPECT_EQ_MSG(memcmp(dump, program, sizeof(program)), 0, "Dumping should read back what was loaded.");
+}
+
+UTEST_F(HardwareFunctionality, OAM_DMA) {
+    DMA dma;
+    utest_fixture->cpu.reset();
+    utest_fixture->cpu.cycles = 1;
+
+    utest_fixture->ram.fill(0x0200, 0xAB, DMA::OAM_SIZE);
+    dma.oam_transfer(utest_fixture->cpu, utest_fixture->ram, 0x02);
+
+    EXPECT_EQ_MSG(dma.oam[0x00], 0xAB, "The first OAM byte should come from $0200.");
+    EXPECT_EQ_MSG(dma.oam[0xFF], 0xAB, "The last OAM byte should come from $02FF.");
+    EXPECT_EQ_MSG(utest_fixture->cpu.cycles, 515u, "A transfer starting on an odd cycle should stall for 514 cycles.");
+}
+
+UTEST_F(HardwareFunctionality, Save_State_Round_Trip) {
+    static constexpr const char* path = "save_state_test.bin";
+
+    utest_fixture->cpu.reset();
+    utest_fixture->cpu.pc     = 0xC000;
+    utest_fixture->cpu.a      = 0x40;
+    utest_fixture->cpu.cycles = 12345;
+    utest_fixture->ram.write(0x0300, 0xAB);
+    utest_fixture->ram.write(0xFFFF, 0xCD);
+
+    ASSERT_TRUE_MSG(SaveState::save(path, utest_fixture->cpu, utest_fixture->ram), "Saving should succeed.");
+
+    CPU cpu = {};
+    RAM ram;
+    ram.write(0x0400, 0xEE);
+
+    WatchLog log = {};
+    ram.set_watch_handler(record_watch_hit, &log);
+    ram.watch(0x0300, RAM::WATCH_READ | RAM::WATCH_WRITE);
+
+    ASSERT_TRUE_MSG(SaveState::load(path, cpu, ram), "Loading should succeed.");
+    EXPECT_EQ_MSG(log.hits, 0u, "Loading a state should not trigger watchpoints.");
+
+    EXPECT_EQ_MSG(cpu.pc, 0xC000, "The program counter should be restored.");
+    EXPECT_EQ_MSG(cpu.a, 0x40, "The A register should be restored.");
+    EXPECT_EQ_MSG(cpu.cycles, 12345u, "The cycle counter should be restored.");
+    EXPECT_EQ_MSG(ram.read(0x0300), 0xAB, "Memory should be restored.");
+    EXPECT_EQ_MSG(ram.read(0xFFFF), 0xCD, "The last page should be restored.");
+    EXPECT_EQ_MSG(ram.read(0x0400), 0x00, "Memory not present in the state should be cleared.");
+
+    static u8 contents[KB(4)];
+    FILE* file        = fopen(path, "rb");
+    const size_t size = fread(contents, 1, sizeof(contents), file);
+    fclose(file);
+    file = fopen(path, "wb");
+    fwrite(contents, 1, size - RAM::PAGE_SIZE, file);
+    fclose(file);
+
+    cpu.pc = 0x1234;
+    ram.write(0x0400, 0xEE);
+    EXPECT_FALSE_MSG(SaveState::load(path, cpu, ram), "A truncated memory chunk should be rejected.");
+    remove(path);
+
+    EXPECT_EQ_MSG(cpu.pc, 0x1234, "A rejected state should leave the registers untouched.");
+    EXPECT_EQ_MSG(ram.read(0x0400), 0xEE, "A rejected state should leave memory untouched.");
+}
+
+UTEST_F(HardwareFunctionality, Rewind_Step_Back) {
+    static constexpr size_t snapshot_count = 8;
+
+    Rewind rewind;
+    rewind.init(KB(256), snapshot_count, 0);
+    utest_fixture->cpu.reset();
+
+    for(size_t i = 0; i < snapshot_count; i++) {
+        utest_fixture->cpu.a      = static_cast<u8>(i);
+        utest_fixture->cpu.cycles = i * 100;
+        utest_fixture->ram.write(0x0200, static_cast<u8>(i));
+        utest_fixture->ram.write(static_cast<u16>(0x8000 + i * RAM::PAGE_SIZE), 0xFF);
+        rewind.push(utest_fixture->cpu, utest_fixture->ram);
+    }
+    EXPECT_EQ_MSG(rewind.snapshots(), snapshot_count, "Every pushed snapshot should be kept.");
+
+    utest_fixture->ram.write(0x0200, 0xEE);
+    utest_fixture->ram.write(0x0300, 0xEE);
+
+    for(size_t i = snapshot_count; i-- > 0;) {
+        ASSERT_TRUE_MSG(rewind.step_back(utest_fixture->cpu, utest_fixture->ram), "Stepping back should succeed while history remains.");
+        EXPECT_EQ_MSG(utest_fixture->cpu.a, static_cast<u8>(i), "The A register should match the snapshot.");
+        EXPECT_EQ_MSG(utest_fixture->cpu.cycles, i * 100, "The cycle counter should match the snapshot.");
+        EXPECT_EQ_MSG(utest_fixture->ram.read(0x0200), static_cast<u8>(i), "Memory should match the snapshot.");
+        EXPECT_EQ_MSG(utest_fixture->ram.read(0x0300), 0x00, "Writes after the newest snapshot should be undone.");
+        EXPECT_EQ_MSG(utest_fixture->ram.read(static_cast<u16>(0x8000 + (i + 1) * RAM::PAGE_SIZE)), 0x00, "Later writes should be undone.");
+    }
+
+    EXPECT_FALSE_MSG(rewind.step_back(utest_fixture->cpu, utest_fixture->ram), "Stepping back past the oldest snapshot should fail.");
+}
+
+UTEST_F(HardwareFunctionality, Rewind_Wrap_Around) {
+    static constexpr size_t round_count  = 4;
+    static constexpr size_t small_pushes = 7000; // Single byte deltas per round, followed by one push that dirties every page
+    static constexpr size_t push_count   = round_count * (small_pushes + 1);
+
+    Rewind rewind;
+    rewind.init(3 * Rewind::MAX_ENTRY_SIZE, push_count, 0);
+    utest_fixture->cpu.reset();
+
+    for(size_t i = 0; i < push_count; i++) {
+        const size_t round = i / (small_pushes + 1);
+
+        utest_fixture->cpu.cycles = i;
+        utest_fixture->ram.write(0x0010, static_cast<u8>(i));
+        utest_fixture->ram.write(0x0011, static_cast<u8>(i >> 8));
+        if(i % (small_pushes + 1) == small_pushes) {
+            for(size_t page = 0; page < RAM::PAGE_COUNT; page++) {
+                utest_fixture->ram.write(static_cast<u16>(page << RAM::PAGE_SHIFT | 0x80), static_cast<u8>(round + 1));
+            }
+        }
+        rewind.push(utest_fixture->cpu, utest_fixture->ram);
+    }
+
+    const size_t kept = rewind.snapshots();
+    EXPECT_GT_MSG(kept, small_pushes, "The buffer should hold history across a full page push.");
+    EXPECT_LT_MSG(kept, push_count, "The buffer should have wrapped several times.");
+
+    for(size_t i = push_count; i-- > push_count - kept;) {
+        const size_t full_pushes = (i + 1) / (small_pushes + 1);
+
+        ASSERT_TRUE_MSG(rewind.step_back(utest_fixture->cpu, utest_fixture->ram), "Stepping back should succeed while history remains.");
+        ASSERT_EQ_MSG(utest_fixture->cpu.cycles, i, "The cycle counter should match the snapshot.");
+        ASSERT_EQ_MSG(utest_fixture->ram.read(0x0010), static_cast<u8>(i), "Memory should match the snapshot.");
+        ASSERT_EQ_MSG(utest_fixture->ram.read(0x0011), static_cast<u8>(i >> 8), "Memory should match the snapshot.");
+        ASSERT_EQ_MSG(utest_fixture->ram.read(0xFF80), static_cast<u8>(full_pushes), "Full page pushes should be undone in order.");
+    }
+
+    EXPECT_FALSE_MSG(rewind.step_back(utest_fixture->cpu, utest_fixture->ram), "Stepping back past the oldest snapshot should fail.");
+}
+
+UTEST(NES, Rewind_Across_Snapshot_Load) {
+    NES nes;
+    nes.power_on();
+    nes.ram.write(0x0200, 0x01);
+
+    NES::Snapshot snapshot;
+    nes.save_snapshot(snapshot);
+    nes.ram.write(0x0200, 0x02);
+    nes.ram.write(0x0300, 0x02);
+
+    Rewind rewind;
+    rewind.init(KB(256), 4, 0);
+    rewind.push(nes.cpu, nes.ram);
+    nes.load_snapshot(snapshot);
+    rewind.push(nes.cpu, nes.ram);
+    nes.ram.write(0x0400, 0x03);
+
+    ASSERT_TRUE(rewind.step_back(nes.cpu, nes.ram));
+    EXPECT_EQ_MSG(nes.ram.read(0x0200), 0x01, "Pages swapped in by a snapshot load should be captured by the next push.");
+    EXPECT_EQ_MSG(nes.ram.read(0x0300), 0x00, "Pages dropped by a snapshot load should be captured by the next push.");
+    EXPECT_EQ_MSG(nes.ram.read(0x0400), 0x00, "Writes after the newest snapshot should be undone.");
+
+    ASSERT_TRUE(rewind.step_back(nes.cpu, nes.ram));
+    EXPECT_EQ_MSG(nes.ram.read(0x0200), 0x02, "Stepping back past the load should restore the memory it replaced.");
+    EXPECT_EQ_MSG(nes.ram.read(0x0300), 0x02, "Stepping back past the load should restore the memory it replaced.");
+}
+
+// Strobes controller 1, stores its first button bit at $10 and counts loop iterations at $11
+static constexpr u8 controller_program[] = {
+    LDA_IMM, 0x01, STA_ABS, 0x16, 0x40, LDA_IMM, 0x00, STA_ABS, 0x16, 0x40,
+    LDA_ABS, 0x16, 0x40, STA_ZP, 0x10, INC_ZP, 0x11, JMP_ABS, 0x00, 0x80,
+};
+
+UTEST(NES, Controller_Read) {
+    NES nes;
+    nes.power_on();
+    nes.ram.load_block(0x8000, controller_program, sizeof(controller_program));
+    nes.cpu.pc = 0x8000;
+
+    nes.set_input(NES::BUTTON_A, 0x00);
+    nes.cpu.execute_instructions(nes.ram, 6);
+    EXPECT_EQ_MSG(nes.ram.read(0x0010), 0x41, "The A button should be the first bit read back, over open bus.");
+
+    nes.set_input(NES::BUTTON_B, 0x00);
+    nes.cpu.execute_instructions(nes.ram, 8);
+    EXPECT_EQ_MSG(nes.ram.read(0x0010), 0x40, "A released A button should read back as zero.");
+}
+
+UTEST(NES, Load_ROM) {
+    static u8 rom[NES::INES_HEADER + NES::PRG_BANK_SIZE] = {'N', 'E', 'S', 0x1A, 1};
+    memcpy(&rom[NES::INES_HEADER], controller_program, sizeof(controller_program));
+    rom[NES::INES_HEADER + (NES::RESET_VECTOR & 0x3FFF) + 1] = 0xC0;
+
+    NES nes;
+    EXPECT_FALSE_MSG(nes.load_rom(rom, NES::INES_HEADER), "A truncated image should be rejected.");
+    ASSERT_TRUE_MSG(nes.load_rom(rom, sizeof(rom)), "An NROM image should load.");
+    EXPECT_EQ_MSG(nes.cpu.pc, 0xC000, "Execution should start at the reset vector.");
+    EXPECT_EQ_MSG(nes.ram.read(0x8000), LDA_IMM, "A single PRG bank should be mapped at $8000.");
+    EXPECT_EQ_MSG(nes.ram.read(0xC000), LDA_IMM, "A single PRG bank should be mirrored at $C000.");
+    EXPECT_EQ_MSG(nes.cpu.sp, 0xFD, "Power on should leave the stack pointer where the reset sequence puts it.");
+
+    nes.run_frame();
+    const u8 iterations = nes.ram.read(0x0011);
+    nes.reset();
+    EXPECT_EQ_MSG(nes.cpu.pc, 0xC000, "A reset should restart at the reset vector.");
+    EXPECT_TRUE_MSG(nes.cpu.has_status(CPU::INTERRUPT_FLAG), "A reset should disable interrupts.");
+    EXPECT_EQ_MSG(nes.ram.read(0x0011), iterations, "A reset should keep memory.");
+
+    nes.run_frame();
+    EXPECT_EQ_MSG(nes.ram.read(0x8000), LDA_IMM, "A reset should keep the cartridge mapped.");
+    EXPECT_NE_MSG(nes.ram.read(0x0011), iterations, "The program should run again after a reset.");
+}
+
+UTEST(NES, PC_Sampler) {
+    static constexpr char debug_info[] =
+        "version\tmajor=2,minor=0\n"
+        "sym\tid=0,name=\"main\",addrsize=absolute,scope=0,def=1,ref=9,val=0x8000,seg=0,type=lab\r\n"
+        "sym\tid=1,name=\"hot\",addrsize=absolute,scope=0,def=2,val=0x8010,seg=0,type=lab\n"
+        "sym\tid=2,name=\"@loop\",addrsize=absolute,scope=0,def=3,val=0x8012,parent=1,seg=0,type=lab\n"
+        "sym\tid=3,name=\"PPUCTRL\",addrsize=absolute,scope=0,def=4,val=0x2000,type=equ";
+    static constexpr char labels[] = "al 008010 .hot_alias\nal 008020 .tail\n";
+
+    u8 program[0x20] = {LDX_IMM, 0x00, JMP_ABS, 0x10, 0x80};
+    for(size_t i = 0; i < 6; i++) {
+        program[0x10 + i * 2]     = INC_ZP;
+        program[0x10 + i * 2 + 1] = 0x00;
+    }
+    program[0x1C] = JMP_ABS;
+    program[0x1D] = 0x00;
+    program[0x1E] = 0x80;
+
+    SymbolTable symbols;
+    symbols.parse(debug_info, sizeof(debug_info) - 1, true);
+    symbols.parse(labels, sizeof(labels) - 1, false);
+    ASSERT_EQ_MSG(symbols.count, 4u, "Equates and cheap locals should be skipped.");
+    EXPECT_STREQ(symbols.name(*symbols.find(0x8015)), "hot");
+    EXPECT_STREQ(symbols.name(*symbols.find(0x8020)), "tail");
+    EXPECT_TRUE_MSG(symbols.find(0x7FFF) == nullptr, "Addresses below every label should not resolve.");
+    EXPECT_TRUE_MSG(symbols.exact(0x8012) == nullptr, "Cheap locals should not be loaded.");
+
+    NES nes;
+    nes.power_on();
+    nes.ram.load_block(0x8000, program, sizeof(program));
+    nes.cpu.pc = 0x8000;
+
+    PCSampler sampler;
+    sampler.init(101, nes.cpu.cycles);
+    nes.sampler = &sampler;
+    nes.run_frame();
+    nes.sampler = nullptr;
+
+    u64 hot_samples = 0;
+    for(u32 address = 0x8010; address < 0x8020; address++) {
+        hot_samples += sampler.histogram[address];
+    }
+    EXPECT_EQ_MSG(sampler.samples, NES::CYCLES_PER_FRAME / 101, "There should be one sample per period.");
+    EXPECT_GT_MSG(hot_samples * 10, sampler.samples * 8, "Most samples should land in the hot loop.");
+
+    FILE* file = tmpfile();
+    ASSERT_TRUE_MSG(file != nullptr, "A temporary file should open.");
+    sampler.report(file, &symbols, 4);
+
+    char report[1024] = {};
+    rewind(file);
+    const size_t length = fread(report, 1, sizeof(report) - 1, file);
+    fclose(file);
+
+    EXPECT_GT(length, 0u);
+    const char* hot  = strstr(report, "hot ($8010)");
+    const char* main = strstr(report, "main ($8000)");
+    EXPECT_TRUE_MSG(hot != nullptr && main != nullptr && hot < main, "The hot loop should head the function report.");
+    EXPECT_TRUE_MSG(strstr(report, "hot+") != nullptr, "Hot addresses should be shown relative to their label.");
+}
+
+UTEST(NES, Call_Graph) {
+    static constexpr char labels[] = "8000 main\n9000 sub\nA000 leaf\n";
+
+    SymbolTable symbols;
+    symbols.parse(labels, sizeof(labels) - 1, false);
+
+    RAM ram;
+    ram.write(0x8001, 0x00);
+    ram.write(0x8002, 0x90);
+    ram.write(0x9004, 0x00);
+    ram.write(0x9005, 0xA0);
+    ram.write(0x8011, 0x00);
+    ram.write(0x8012, 0xA0);
+
+    CallGraph call_graph;
+    call_graph.init(0x8000, 0);
+    call_graph.step(ram, 0x8000, CallGraph::JSR, 0xFD, 10);
+    call_graph.step(ram, 0x9003, CallGraph::JSR, 0xFB, 30);
+    call_graph.step(ram, 0xA010, CallGraph::RTS, 0xF9, 45);
+    call_graph.step(ram, 0x9010, CallGraph::RTS, 0xF9, 50); // Pushed a jump target and returned to it
+    call_graph.step(ram, 0x9020, CallGraph::RTS, 0xFB, 60);
+    call_graph.step(ram, 0x8000, CallGraph::JSR, 0xFD, 70);
+    call_graph.step(ram, 0x8010, CallGraph::JSR, 0xFD, 80); // The stack was reset with TXS before this call
+    call_graph.step(ram, 0x8013, LDA_IMM, 0xFB, 90);
+    call_graph.finish(100);
+
+    EXPECT_EQ_MSG(call_graph.unmatched, 1u, "The RTS used as a jump should not pop a frame.");
+    EXPECT_EQ_MSG(call_graph.discarded, 1u, "The frame abandoned by the stack reset should be discarded.");
+    EXPECT_EQ_MSG(call_graph.depth, 1u, "Only the last call should be on the shadow stack.");
+
+    FILE* file = tmpfile();
+    ASSERT_TRUE_MSG(file != nullptr, "A temporary file should open.");
+    call_graph.write_folded(file, &symbols);
+
+    char folded[256] = {};
+    rewind(file);
+    const size_t length = fread(folded, 1, sizeof(folded) - 1, file);
+    fclose(file);
+
+    EXPECT_GT(length, 0u);
+    EXPECT_STREQ(folded, "main 20\nmain;sub 45\nmain;sub;leaf 15\nmain;leaf 20\n");
+}
+
+UTEST(NES, Code_Data_Log) {
+    static constexpr const char* path = "code_data_log_test.cdl";
+    static constexpr size_t prg_size  = NES::PRG_BANK_SIZE;
+    static constexpr size_t chr_size  = KB(8);
+    static constexpr u8 program[]     = {LDX_IMM, 0x02, LDA_ABSX, 0x00, 0x81, STA_ZP, 0x10, JMP_IND, 0x00, 0x82};
+    static constexpr u8 jump_table[]  = {0x00, 0x80};
+
+    NES nes;
+    nes.power_on();
+    nes.ram.load_block(0x8000, program, sizeof(program));
+    nes.ram.load_block(0x8200, jump_table, sizeof(jump_table));
+    nes.cpu.pc = 0x8000;
+
+    CodeDataLog* cdl = new CodeDataLog;
+    cdl->clear();
+    nes.cpu.cdl = cdl;
+    nes.cpu.execute_instructions(nes.ram, 4);
+    nes.cpu.cdl = nullptr;
+
+    EXPECT_EQ(cdl->flags[0x8000], CodeDataLog::CODE | CodeDataLog::OPCODE | CodeDataLog::INDIRECT_CODE);
+    EXPECT_EQ(cdl->flags[0x8001], CodeDataLog::CODE);
+    EXPECT_EQ_MSG(cdl->flags[0x8102], CodeDataLog::DATA, "Indexed reads should mark the effective address.");
+    EXPECT_EQ_MSG(cdl->flags[0x0010], 0, "Stores should not be marked as data reads.");
+    EXPECT_EQ_MSG(cdl->flags[0x8201], CodeDataLog::DATA, "Jump table pointers should be marked as data.");
+
+    nes.cpu.cdl = cdl;
+    nes.ram.write(DMA::OAM_DMA, 0x83);
+    nes.reset();
+    nes.cpu.cdl = nullptr;
+
+    EXPECT_EQ_MSG(cdl->flags[0x8300], CodeDataLog::DATA, "OAM DMA should mark its source page as data.");
+    EXPECT_EQ_MSG(cdl->flags[0x83FF], CodeDataLog::DATA, "OAM DMA should mark its source page as data.");
+    EXPECT_EQ_MSG(cdl->flags[0xFFFD], CodeDataLog::DATA, "The reset vector should be marked as data.");
+
+    ASSERT_TRUE_MSG(cdl->save(path, prg_size, chr_size), "The log should be saved.");
+
+    FILE* file = fopen(path, "rb");
+    ASSERT_TRUE_MSG(file != nullptr, "The log file should exist.");
+    fseek(file, 0, SEEK_END);
+    EXPECT_EQ_MSG(static_cast<size_t>(ftell(file)), prg_size + chr_size, "The file should hold one byte per PRG and CHR byte.");
+    fclose(file);
+
+    cdl->clear();
+    ASSERT_TRUE_MSG(cdl->load(path, prg_size), "The log should load back.");
+    remove(path);
+
+    EXPECT_EQ_MSG(cdl->flags[0xC102], CodeDataLog::DATA, "A 16 KB image should be marked in both mirrors.");
+    EXPECT_EQ(cdl->flags[0x8005], CodeDataLog::CODE | CodeDataLog::OPCODE);
+    delete cdl;
+}
+
+UTEST(NES, Breakpoints) {
+    static constexpr u8 program[] = {INC_ABS, 0x00, 0x03, LDX_ABS, 0x00, 0x03, JMP_ABS, 0x00, 0x80};
+
+    NES nes;
+    nes.power_on();
+    nes.ram.load_block(0x8000, program, sizeof(program));
+    nes.cpu.pc = 0x8000;
+
+    Breakpoints* breakpoints = new Breakpoints;
+    breakpoints->attach(nes.ram);
+    nes.breakpoints = breakpoints;
+
+    const int execute = breakpoints->add("pc == $8003 && [$0300] == 5 && x == 4");
+    ASSERT_GE_MSG(execute, 0, "The condition should compile with its pc term as the trigger.");
+
+    nes.run_frame();
+    ASSERT_TRUE_MSG(breakpoints->stopped, "The breakpoint should stop the frame.");
+    EXPECT_EQ_MSG(nes.cpu.pc, 0x8003, "Execute breakpoints stop before the instruction runs.");
+    EXPECT_EQ(nes.ram.peek(0x0300), 5);
+    EXPECT_EQ(nes.cpu.x, 4);
+
+    const u64 first_stop = nes.cpu.cycles;
+    nes.run_frame();
+    ASSERT_TRUE_MSG(breakpoints->stopped, "Resuming should run on to the next time the condition holds.");
+    EXPECT_TRUE_MSG(nes.cpu.cycles > first_stop, "Resuming should not stop on the same instruction again.");
+    EXPECT_EQ(nes.ram.peek(0x0300), 5);
+    EXPECT_EQ(breakpoints->breakpoints[execute].hits, 2u);
+
+    breakpoints->remove(execute);
+    const int write = breakpoints->add(Breakpoints::WRITE, 0x0300, "value == $10 && address == $0300");
+    ASSERT_GE(write, 0);
+
+    nes.run_frame();
+    ASSERT_TRUE_MSG(breakpoints->stopped, "Write breakpoints should stop the run.");
+    EXPECT_EQ(breakpoints->hit, static_cast<u32>(write));
+    EXPECT_EQ_MSG(nes.cpu.pc, 0x8003, "Write breakpoints stop after the instruction that wrote.");
+    EXPECT_EQ(nes.ram.peek(0x0300), 0x10);
+
+    breakpoints->remove(write);
+    const u64 frame = nes.frame();
+    nes.run_frame();
+    EXPECT_FALSE_MSG(breakpoints->stopped, "Removed breakpoints should not stop the run.");
+    EXPECT_EQ(nes.frame(), frame + 1);
+
+    // A run that ends right after the INC makes its write stop that run, not the next one
+    const int last_write = breakpoints->add(Breakpoints::WRITE, 0x0300);
+    ASSERT_GE(last_write, 0);
+    nes.cpu.pc = 0x8000;
+    nes.run_cycles(6);
+    EXPECT_TRUE_MSG(breakpoints->stopped, "A write by the last instruction of a run should stop that run.");
+    nes.run_cycles(6);
+    EXPECT_FALSE_MSG(breakpoints->stopped, "A write reported by one run should not stop the next.");
+
+    nes.breakpoints = nullptr;
+    delete breakpoints;
+
+    nes.ram.watch(0x0300, RAM::WATCH_WRITE);
+    nes.run_frame(); // Watch hits must not reach the destroyed breakpoints
+    EXPECT_EQ(nes.frame(), frame + 2);
+}
+
+UTEST(NES, Breakpoint_Conditions) {
+    NES nes;
+    nes.power_on();
+    nes.ram.write(0x0010, 0x80);
+    nes.cpu.a = 6;
+    nes.cpu.x = 0x10;
+    nes.cpu.s = CPU::CARRY_FLAG;
+
+    Breakpoints breakpoints;
+    auto evaluate = [&](const char* condition) -> s64 {
+        const int id = breakpoints.add(Breakpoints::EXECUTE, 0x8000, condition);
+        return id < 0 ? -1 : static_cast<s64>(breakpoints.evaluate(breakpoints.breakpoints[id], nes.cpu, nes.ram, {}));
+    };
+
+    EXPECT_EQ_MSG(evaluate("a + 2 & 3 == 0"), 1, "Bitwise and arithmetic operators should bind tighter than comparisons.");
+    EXPECT_EQ(evaluate("[x] == $80 && c && !z"), 1);
+    const char* binary = "a < 5 || [x + 0] >= %10000000"; // Kept out of the macro, which uses its arguments as a format string
+    EXPECT_EQ(evaluate(binary), 1);
+    EXPECT_EQ(evaluate("(a - 7) > 1000"), 1);
+    EXPECT_EQ(evaluate("A == 6 && 0x10 != X"), 0);
+    EXPECT_EQ_MSG(evaluate(""), 1, "An empty condition should always hold.");
+
+    EXPECT_EQ_MSG(evaluate("a >"), -1, "Incomplete conditions should be rejected.");
+    EXPECT_EQ(breakpoints.error_column, 3u);
+    EXPECT_EQ_MSG(evaluate("a == q"), -1, "Unknown names should be rejected.");
+    EXPECT_EQ(breakpoints.error_column, 5u);
+    EXPECT_EQ_MSG(breakpoints.add("a > 10"), -1, "A condition without a pc term needs an address.");
+    EXPECT_EQ_MSG(breakpoints.add("pc == $C000 || a > 10"), -1, "A pc term in one alternative cannot trigger the other.");
+    EXPECT_EQ_MSG(breakpoints.add(Breakpoints::WRITE, 0x0300), -1, "Write breakpoints need attached RAM.");
+
+    static char nested[1000002];
+    memset(nested, '(', Breakpoints::MAX_NESTING);
+    strcpy(&nested[Breakpoints::MAX_NESTING], "!a");
+    EXPECT_EQ_MSG(evaluate(nested), -1, "Brackets and ! operators should share the nesting limit.");
+    EXPECT_EQ(breakpoints.error_column, Breakpoints::MAX_NESTING);
+    memset(nested, '[', sizeof(nested) - 1);
+    EXPECT_EQ_MSG(evaluate(nested), -1, "Deep nesting should be rejected without exhausting the stack.");
+    EXPECT_STREQ(breakpoints.error, "condition nests too deeply");
+    memset(nested, '(', Breakpoints::MAX_NESTING);
+    strcpy(&nested[Breakpoints::MAX_NESTING], "1");
+    memset(&nested[Breakpoints::MAX_NESTING + 1], ')', Breakpoints::MAX_NESTING);
+    nested[2 * Breakpoints::MAX_NESTING + 1] = '\0';
+    EXPECT_EQ_MSG(evaluate(nested), 1, "Nesting up to the limit should be accepted.");
+}
+
+UTEST(NES, Movie_Replay_And_Seek) {
+    static constexpr size_t frame_count = 150;
+
+    NES nes;
+    nes.power_on();
+    nes.ram.load_block(0x8000, controller_program, sizeof(controller_program));
+    nes.cpu.pc = 0x8000;
+
+    Movie movie;
+    movie.keyframe_interval = 16;
+    movie.begin_recording(nes);
+    for(size_t i = 0; i < frame_count; i++) {
+        movie.record_frame(nes, {{static_cast<u8>((i / 3) & 1), 0x00}});
+    }
+    const u64 final_hash = nes.state_hash();
+
+    movie.begin_playback(nes);
+    while(movie.play_frame(nes)) {
+    }
+    EXPECT_EQ_MSG(movie.first_desync, 0u, "Playback should reproduce every recorded frame.");
+    EXPECT_EQ_MSG(nes.state_hash(), final_hash, "Playback should end in the recorded state.");
+
+    // $11 counts loop iterations and passes 3 a few times per frame, so the breakpoint stops playback part way through frames
+    Breakpoints breakpoints;
+    const int breakpoint = breakpoints.add("pc == $800F && [$11] == 3");
+    ASSERT_GE(breakpoint, 0);
+    nes.breakpoints = &breakpoints;
+
+    size_t stops = 0;
+    movie.begin_playback(nes);
+    while(movie.play_frame(nes)) {
+        stops += breakpoints.stopped;
+    }
+    EXPECT_GT_MSG(stops, 0u, "The breakpoint should stop playback.");
+    EXPECT_EQ_MSG(movie.first_desync, 0u, "Frames stopped by a breakpoint should not be reported as desynced.");
+    EXPECT_EQ_MSG(nes.state_hash(), final_hash, "Playback with stops should still end in the recorded state.");
+
+    const u64 hits = breakpoints.breakpoints[breakpoint].hits;
+    EXPECT_TRUE_MSG(movie.seek(nes, 100), "Seeking should stay in sync with the recording.");
+    EXPECT_EQ_MSG(nes.frame(), 100u, "Seeking should stop at the requested frame.");
+    EXPECT_EQ_MSG(nes.state_hash(), movie.hashes[99], "Seeking should reproduce the recorded state.");
+    EXPECT_EQ_MSG(breakpoints.breakpoints[breakpoint].hits, hits, "Seeking should not stop at breakpoints.");
+    nes.breakpoints = nullptr;
+
+    movie.hashes[129] ^= 1;
+    EXPECT_FALSE_MSG(movie.seek(nes, 130), "A corrupted hash should be reported as a desync.");
+    EXPECT_EQ_MSG(movie.first_desync, 130u, "The first desynced frame should be recorded.");
+
+    static constexpr const char* path = "movie_test.bin";
+    static constexpr u8 truncated[2]  = {};
+    SaveState::Writer writer;
+    ASSERT_TRUE(writer.open(path));
+    nes.write_state(writer);
+    writer.begin_chunk(Movie::INPUT_CHUNK, Movie::INPUT_CHUNK_VERSION);
+    writer.write(truncated, sizeof(truncated));
+    writer.end_chunk();
+    writer.begin_chunk(Movie::HASH_CHUNK, Movie::HASH_CHUNK_VERSION);
+    writer.write(truncated, sizeof(truncated));
+    writer.end_chunk();
+    ASSERT_TRUE(writer.close());
+
+    Movie loaded;
+    EXPECT_FALSE_MSG(loaded.load(path), "Chunks too short to hold a frame count should be rejected.");
+    loaded.begin_playback(nes);
+    EXPECT_FALSE_MSG(loaded.play_frame(nes), "An empty movie should have nothing to play.");
+    remove(path);
+}
+
+UTEST(NES, Movie_Seek_Detaches_Observers) {
+    static constexpr const char* path = "movie_seek_test.txt";
+
+    NES nes;
+    nes.power_on();
+    nes.ram.load_block(0x8000, controller_program, sizeof(controller_program));
+    nes.cpu.pc = 0x8000;
+
+    Movie movie;
+    movie.keyframe_interval = 16;
+    movie.begin_recording(nes);
+    for(size_t i = 0; i < 40; i++) {
+        movie.record_frame(nes, {{0x00, 0x00}});
+    }
+
+    TraceLog trace_log;
+    ASSERT_TRUE_MSG(trace_log.open(path, &nes.ram), "The log file should open.");
+    PCSampler sampler;
+    sampler.init(101, nes.cpu.cycles);
+    CallGraph call_graph;
+    call_graph.init(nes.cpu.pc, nes.cpu.cycles);
+    CodeDataLog* cdl = new CodeDataLog;
+    cdl->clear();
+
+    nes.cpu.trace_log  = &trace_log;
+    nes.cpu.call_graph = &call_graph;
+    nes.cpu.cdl        = cdl;
+    nes.sampler        = &sampler;
+#if defined(NES_PROFILE)
+    OpcodeProfile profile;
+    nes.cpu.profile = &profile;
+#endif
+
+    EXPECT_TRUE(movie.seek(nes, 30));
+    EXPECT_EQ_MSG(trace_log.lines, 0u, "Seeking should not log the frames it replays.");
+    EXPECT_TRUE_MSG(nes.cpu.trace_log == &trace_log, "The trace log should be attached again after seeking.");
+    EXPECT_EQ_MSG(sampler.samples, 0u, "Seeking should not sample the frames it replays.");
+    EXPECT_TRUE_MSG(nes.sampler == &sampler, "The sampler should be attached again after seeking.");
+    EXPECT_TRUE_MSG(nes.cpu.call_graph == &call_graph, "The call graph should be attached again after seeking.");
+    EXPECT_EQ_MSG(cdl->flags[0x8000], 0, "Seeking should not log the code it replays.");
+    EXPECT_TRUE_MSG(nes.cpu.cdl == cdl, "The code/data log should be attached again after seeking.");
+#if defined(NES_PROFILE)
+    EXPECT_EQ_MSG(profile.count(INC_ZP), 0u, "Seeking should not count the instructions it replays.");
+    EXPECT_TRUE_MSG(nes.cpu.profile == &profile, "The profile should be attached again after seeking.");
+    nes.cpu.profile = nullptr;
+#endif
+
+    nes.cpu.trace_log  = nullptr;
+    nes.cpu.call_graph = nullptr;
+    nes.cpu.cdl        = nullptr;
+    nes.sampler        = nullptr;
+    trace_log.close();
+    remove(path);
+    delete cdl;
+}
+
+UTEST(NES, Fork) {
+    NES parent;
+    parent.power_on();
+    parent.ram.load_block(0x8000, controller_program, sizeof(controller_program));
+    parent.cpu.pc = 0x8000;
+    parent.run_frame();
+
+    NES child;
+    parent.fork(child);
+    EXPECT_EQ_MSG(child.state_hash(), parent.state_hash(), "A fork should start in the parent's state.");
+    EXPECT_EQ_MSG(child.ram.private_pages(), 0u, "A fork should not copy any memory up front.");
+
+    child.set_input(NES::BUTTON_A, 0x00);
+    child.run_frame();
+    parent.run_frame();
+
+    EXPECT_EQ_MSG(child.ram.read(0x0010), 0x41, "The fork should see its own input.");
+    EXPECT_EQ_MSG(parent.ram.read(0x0010), 0x40, "The parent should not see the fork's writes.");
+    EXPECT_EQ_MSG(child.ram.read(0x8000), LDA_IMM, "The fork should share the parent's program.");
+    EXPECT_EQ_MSG(child.ram.private_pages(), 1u, "Only the zero page written by the fork should have been copied.");
+}
+
+UTEST(Batch, Lockstep_Step) {
+    static constexpr size_t instance_count = 10;
+
+    BatchRunner batch;
+    batch.init(instance_count, 3);
+    for(size_t i = 0; i < instance_count; i++) {
+        batch.instances[i]->ram.load_block(0x8000, controller_program, sizeof(controller_program));
+        batch.instances[i]->cpu.pc = 0x8000;
+    }
+
+    u8 actions[instance_count];
+    for(size_t i = 0; i < instance_count; i++) {
+        actions[i] = (i & 1) ? NES::BUTTON_A : 0x00;
+    }
+    batch.step(actions);
+    batch.step(actions);
+
+    EXPECT_EQ_MSG(batch.steps, 2 * instance_count, "Every instance should be stepped once per step.");
+    EXPECT_TRUE_MSG(batch.steps_per_second() > 0.0, "Throughput should be reported.");
+    for(size_t i = 0; i < instance_count; i++) {
+        EXPECT_EQ_MSG(batch.instances[i]->frame(), 2u, "Every instance should run one frame per step.");
+        EXPECT_EQ_MSG(batch.observation(i)[0x10], (i & 1) ? 0x41 : 0x40, "Each observation should reflect its own action.");
+        EXPECT_EQ_MSG(batch.observation(i)[0x11], batch.instances[i]->ram.read(0x0011), "Observations should hold work RAM.");
+    }
+}
+
+static bool count_item(void* context, const size_t item, const size_t worker) {
+    static_cast<std::atomic<u32>*>(context)[item].fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+UTEST(Batch, Scheduler_Grows_Deques) {
+    static constexpr size_t item_count = 1000;
+    static std::atomic<u32> runs[item_count];
+
+    Scheduler scheduler;
+    scheduler.init(2, 4);
+    scheduler.run(item_count, count_item, runs);
+
+    size_t ran_once = 0;
+    for(const std::atomic<u32>& count : runs) {
+        ran_once += count.load() == 1;
+    }
+    EXPECT_EQ_MSG(ran_once, item_count, "A batch larger than the initial size should run every item exactly once.");
+}
+
+UTEST(Batch, Sliced_Run_Cycles) {
+    static constexpr size_t instance_count = 6;
+
+    BatchRunner batch;
+    batch.init(instance_count, 4);
+    for(size_t i = 0; i < instance_count; i++) {
+        batch.instances[i]->ram.load_block(0x8000, controller_program, sizeof(controller_program));
+        batch.instances[i]->cpu.pc     = 0x8000;
+        batch.instances[i]->cpu.cycles = i * 500; // Uneven starting points
+    }
+
+    batch.run_cycles(10000, 1000);
+    for(size_t i = 0; i < instance_count; i++) {
+        const u64 target = i * 500 + 10000;
+        EXPECT_TRUE_MSG(batch.instances[i]->cpu.cycles >= target, "Every instance should run its whole budget.");
+        EXPECT_TRUE_MSG(batch.instances[i]->cpu.cycles < target + 8, "No instance should run past its budget by more than one instruction.");
+    }
+    EXPECT_TRUE_MSG(batch.scheduler.total_slices() >= instance_count * 10, "The budget should be cut into slices.");
+
+    const u64 slices = batch.scheduler.total_slices();
+    batch.run_cycles(1000, 0);
+    EXPECT_EQ_MSG(batch.scheduler.total_slices(), slices + instance_count, "A slice of 0 should run the whole budget at once.");
+    EXPECT_TRUE_MSG(batch.instances[0]->cpu.cycles >= 11000, "A slice of 0 should run the whole budget.");
+}
+
+UTEST(Batch, Placement) {
+    BatchRunner batch;
+    batch.init(8, 2, Placement::SCATTER);
+
+    EXPECT_TRUE_MSG(batch.scheduler.topology.cpu_count > 0, "Placement should detect at least one CPU.");
+    EXPECT_TRUE_MSG(batch.scheduler.topology.node_count > 0, "Placement should detect at least one node.");
+
+    u8 actions[8] = {};
+    batch.step(actions);
+    for(size_t i = 0; i < 8; i++) {
+        EXPECT_EQ_MSG(batch.instances[i]->frame(), 1u, "Placed instances should run like any other.");
+    }
+}
+
+UTEST(Batch, Stats_Page) {
+    static constexpr size_t instance_count = 4;
+
+    char name[StatsPage::NAME_LENGTH];
+    snprintf(name, sizeof(name), "nes-stats-test-%llu", (unsigned long long)std::chrono::steady_clock::now().time_since_epoch().count());
+
+    StatsPage publisher;
+    ASSERT_TRUE_MSG(publisher.create(name, instance_count), "The page should be created.");
+
+    BatchRunner batch;
+    batch.init(instance_count, 2);
+    batch.stats = &publisher;
+    for(size_t i = 0; i < instance_count; i++) {
+        batch.instances[i]->ram.load_block(0x8000, controller_program, sizeof(controller_program));
+        batch.instances[i]->cpu.pc = 0x8000;
+    }
+
+    u8 actions[instance_count] = {};
+    batch.step(actions);
+    batch.step(actions);
+
+    StatsPage reader;
+    ASSERT_TRUE_MSG(reader.open(name), "A reader should map the page by name.");
+
+    StatsPage::Totals totals;
+    StatsPage::Instance rows[instance_count];
+    ASSERT_TRUE_MSG(reader.read(totals, rows, instance_count), "A read between updates should succeed.");
+    EXPECT_EQ_MSG(totals.updates, 2u, "The page should be updated once per step.");
+    EXPECT_EQ_MSG(totals.instance_count, static_cast<u32>(instance_count), "Every instance should be published.");
+    EXPECT_EQ_MSG(totals.frames, 2 * instance_count, "Frames should be totalled over the instances.");
+    EXPECT_TRUE_MSG(totals.mips > 0.0 && totals.speed > 0.0, "Rates should be worked out from the last update.");
+
+    u64 instructions = 0;
+    for(size_t i = 0; i < instance_count; i++) {
+        EXPECT_EQ_MSG(rows[i].cycles, batch.instances[i]->cpu.cycles, "Rows should hold each instance's cycles.");
+        EXPECT_TRUE_MSG(rows[i].instructions > 0, "Rows should count instructions.");
+        instructions += rows[i].instructions;
+    }
+    EXPECT_EQ_MSG(totals.instructions, instructions, "Instructions should be totalled over the instances.");
+
+    // A publisher stuck mid-update never yields a torn read
+    StatsPage::Instance* pending = publisher.begin_update(instance_count);
+    pending[0].cycles            = 0;
+    EXPECT_FALSE_MSG(reader.read(totals, rows, instance_count, 10), "Reads should fail while an update is in progress.");
+    publisher.end_update();
+    EXPECT_TRUE_MSG(reader.read(totals, rows, instance_count), "Reads should succeed once the update is published.");
+    EXPECT_EQ_MSG(totals.updates, 3u, "The finished update should be visible.");
+}
+
+UTEST(Lockstep, Matches_Scalar) {
+    // Mixes lane-wide and scalar instructions; the indirect jump splits the lanes between two loops that meet again at $8000
+    static constexpr u8 program[] = {
+        LDX_IMM, 0x05, INX, TXA, AND_IMM, 0x0F, TAY, STA_ZP, 0x10, LDA_ZP, 0x20, TAX, SEC, DEY, JMP_IND, 0x30, 0x00,
+    };
+    static constexpr u8 detour[] = {INY, CLC, INC_ZP, 0x21, JMP_ABS, 0x00, 0x80};
+
+    Machine reference[Lockstep::LANES];
+    Machine lanes[Lockstep::LANES];
+    Lockstep lockstep;
+    for(size_t i = 0; i < Lockstep::LANES; i++) {
+        for(Machine* machine : {&reference[i], &lanes[i]}) {
+            machine->power_on();
+            machine->ram.load_block(0x8000, program, sizeof(program));
+            machine->ram.load_block(0x8100, detour, sizeof(detour));
+            machine->ram.write(0x0020, static_cast<u8>(i * 7));
+            machine->ram.write(0x0031, (i % 3) ? 0x80 : 0x81);
+            machine->cpu.pc = 0x8000;
+        }
+        lockstep.load(i, lanes[i].cpu, lanes[i].ram);
+    }
+
+    lockstep.execute_instructions(200);
+    for(size_t i = 0; i < Lockstep::LANES; i++) {
+        reference[i].cpu.execute_instructions(reference[i].ram, 200);
+        lockstep.store(i, lanes[i].cpu);
+
+        EXPECT_EQ_MSG(lanes[i].cpu.pc, reference[i].cpu.pc, "Lanes should end at the scalar program counter.");
+        EXPECT_EQ_MSG(lanes[i].cpu.a, reference[i].cpu.a, "Lanes should match the scalar A register.");
+        EXPECT_EQ_MSG(lanes[i].cpu.x, reference[i].cpu.x, "Lanes should match the scalar X register.");
+        EXPECT_EQ_MSG(lanes[i].cpu.y, reference[i].cpu.y, "Lanes should match the scalar Y register.");
+        EXPECT_EQ_MSG(lanes[i].cpu.s, reference[i].cpu.s, "Lanes should match the scalar status flags.");
+        EXPECT_EQ_MSG(lanes[i].cpu.cycles, reference[i].cpu.cycles, "Lanes should match the scalar cycle count.");
+        EXPECT_EQ_MSG(lanes[i].ram.read(0x0021), reference[i].ram.read(0x0021), "Lanes should match scalar memory.");
+    }
+    EXPECT_TRUE_MSG(lockstep.vector_steps > 0, "Register instructions should run across lanes.");
+}
+
+UTEST(Lockstep, Staggered_Shared_Code) {
+    // Lanes that start one instruction apart converge on the first step and still have different instruction counts left
+    u8 program[64];
+    memset(program, INX, sizeof(program));
+    MemoryImage image;
+    image.load(0x8000, program, sizeof(program));
+
+    for(const u16 first_pc : {u16(0x8001), u16(0x8000)}) {
+        Machine reference[2];
+        Machine lanes[2];
+        Lockstep lockstep;
+        for(size_t i = 0; i < 2; i++) {
+            for(Machine* machine : {&reference[i], &lanes[i]}) {
+                machine->power_on();
+                machine->ram.attach(image);
+                machine->cpu.pc = static_cast<u16>(i == 0 ? first_pc : first_pc ^ 1);
+            }
+            lockstep.load(i, lanes[i].cpu, lanes[i].ram);
+        }
+
+        lockstep.execute_instructions(4);
+        for(size_t i = 0; i < 2; i++) {
+            reference[i].cpu.execute_instructions(reference[i].ram, 4);
+            lockstep.store(i, lanes[i].cpu);
+
+            EXPECT_EQ_MSG(lanes[i].cpu.pc, reference[i].cpu.pc, "Every lane should run exactly the requested instructions.");
+            EXPECT_EQ_MSG(lanes[i].cpu.x, reference[i].cpu.x, "Lanes should match the scalar X register.");
+            EXPECT_EQ_MSG(lanes[i].cpu.cycles, reference[i].cpu.cycles, "Lanes should match the scalar cycle count.");
+        }
+    }
+}
+
+UTEST(Arena, Instance_Reuse) {
+    InstanceArena<Machine> arena;
+    Machine* first  = arena.acquire();
+    Machine* second = arena.acquire();
+
+    EXPECT_EQ_MSG(arena.capacity(), InstanceArena<Machine>::SLAB_INSTANCES, "The first acquire should allocate exactly one slab.");
+    EXPECT_TRUE_MSG(reinterpret_cast<uintptr_t>(second) % 64 == 0, "Slots should be cache line aligned.");
+    EXPECT_TRUE_MSG(first->cpu.instructions == second->cpu.instructions, "Instances should share one instruction table.");
+
+    first->ram.write(0x0000, LDA_IMM);
+    first->ram.write(0x0001, 0x42);
+    first->cpu.execute(first->ram);
+    EXPECT_EQ_MSG(first->cpu.a, 0x42, "An acquired instance should be ready to execute.");
+
+    arena.release(first);
+    Machine* reused = arena.acquire();
+    EXPECT_TRUE_MSG(reused == first, "A released slot should be handed out again.");
+    EXPECT_EQ_MSG(reused->cpu.a, 0x00, "A reused instance should be back in its power-on state.");
+    EXPECT_EQ_MSG(reused->cpu.cycles, 0u, "A reused instance should have its cycle counter reset.");
+    EXPECT_EQ_MSG(reused->ram.private_pages(), 0u, "A reused instance should not hold any pages.");
+    EXPECT_EQ_MSG(reused->ram.read(0x0001), 0x00, "A reused instance should read zeroed memory.");
+
+    InstanceArena<NES> consoles;
+    NES* console = consoles.acquire();
+    BusTrace trace;
+    PCSampler sampler;
+    WatchLog log = {};
+    console->ram.attach_trace(&trace);
+    console->ram.set_watch_handler(record_watch_hit, &log);
+    console->ram.watch(0x0300, RAM::WATCH_WRITE);
+    console->sampler = &sampler;
+
+    consoles.release(console);
+    NES* recycled = consoles.acquire();
+    EXPECT_TRUE_MSG(recycled == console, "A released console should be handed out again.");
+    EXPECT_TRUE_MSG(recycled->sampler == nullptr, "A recycled console should not keep its previous owner's sampler.");
+    EXPECT_TRUE_MSG(recycled->ram.attached_trace() == nullptr, "A recycled console should not keep its previous owner's bus trace.");
+    recycled->ram.write(0x0300, 0x01);
+    EXPECT_EQ_MSG(log.hits, 0u, "A recycled console should not keep its previous owner's watchpoints.");
+}
+
 UTEST_F(Instructions, NOP) {
     utest_fixture->cpu.reset();
 
@@ -230,7 +1475,7 @@ UTEST_F(Instructions, AND_ZeroPage_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x00FF.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -249,7 +1494,7 @@ UTEST_F(Instructions, AND_ZeroPage_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x00FF.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -268,7 +1513,7 @@ UTEST_F(Instructions, AND_ZeroPage_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0xFF, utest_fixture->cpu.a, "The A register's value should be 0xFF (255).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x00FF.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -289,7 +1534,7 @@ UTEST_F(Instructions, AND_ZeroPageX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x008F.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -310,7 +1555,7 @@ UTEST_F(Instructions, AND_ZeroPageX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x008F.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -331,7 +1576,7 @@ UTEST_F(Instructions, AND_ZeroPageX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0xFF, utest_fixture->cpu.a, "The A register's value should be 0xFF (255).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x008F.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -351,7 +1596,7 @@ UTEST_F(Instructions, AND_Absolute_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0xAABB.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0xAABB.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -371,7 +1616,7 @@ UTEST_F(Instructions, AND_Absolute_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0xAABB.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0xAABB.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -391,7 +1636,7 @@ UTEST_F(Instructions, AND_Absolute_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0xFF, utest_fixture->cpu.a, "The A register's value should be 0xFF (255).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0xAABB.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0xAABB.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -413,7 +1658,7 @@ UTEST_F(Instructions, AND_AbsoluteX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x082C.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -435,7 +1680,7 @@ UTEST_F(Instructions, AND_AbsoluteX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x082C.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -457,7 +1702,7 @@ UTEST_F(Instructions, AND_AbsoluteX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0xFF, utest_fixture->cpu.a, "The A register's value should be 0xFF (255).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x082C.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x082C.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -479,7 +1724,7 @@ UTEST_F(Instructions, AND_AbsoluteY_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x082C.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -501,7 +1746,7 @@ UTEST_F(Instructions, AND_AbsoluteY_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x082C.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -523,7 +1768,7 @@ UTEST_F(Instructions, AND_AbsoluteY_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0xFF, utest_fixture->cpu.a, "The A register's value should be 0xFF (255).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_read, "The A register should have been compared to the zero page address 0x082C.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been compared to the zero page address 0x082C.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -577,7 +1822,7 @@ UTEST_F(Instructions, LDA_ZeroPage_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The A register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been populated from the zero page address 0x00FF.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -592,7 +1837,7 @@ UTEST_F(Instructions, LDA_ZeroPage_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The A register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been populated from the zero page address 0x00FF.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -607,7 +1852,7 @@ UTEST_F(Instructions, LDA_ZeroPage_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.a, "The A register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The A register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been populated from the zero page address 0x00FF.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -626,7 +1871,7 @@ UTEST_F(Instructions, LDA_ZeroPageX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The A register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been populated from address 0x008F.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -645,7 +1890,7 @@ UTEST_F(Instructions, LDA_ZeroPageX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The A register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been populated from address 0x008F.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -664,7 +1909,7 @@ UTEST_F(Instructions, LDA_ZeroPageX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.a, "The A register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The A register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The A register should have been populated from address 0x008F.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -683,7 +1928,7 @@ UTEST_F(Instructions, LDA_ZeroPageX_WrappingCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.a, "The A register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x007F, utest_fixture->ram.most_recent_read, "With wrapping, the A register should have been populated from address 0x007F.");
+    EXPECT_EQ_MSG(0x007F, utest_fixture->trace.most_recent(BusTrace::READ), "With wrapping, the A register should have been populated from address 0x007F.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -699,7 +1944,7 @@ UTEST_F(Instructions, LDA_Absolute_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The A register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The A register should have been populated from the address 0xAABB.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -715,7 +1960,7 @@ UTEST_F(Instructions, LDA_Absolute_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The A register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The A register should have been populated from the address 0xAABB.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -731,7 +1976,7 @@ UTEST_F(Instructions, LDA_Absolute_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.a, "The A register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The A register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The A register should have been populated from the address 0xAABB.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -751,7 +1996,7 @@ UTEST_F(Instructions, LDA_AbsoluteX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The A register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The A register should have been populated from the address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -771,7 +2016,7 @@ UTEST_F(Instructions, LDA_AbsoluteX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The A register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The A register should have been populated from the address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -791,7 +2036,7 @@ UTEST_F(Instructions, LDA_AbsoluteX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.a, "The A register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The A register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The A register should have been populated from the address 0x082C.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -811,7 +2056,7 @@ UTEST_F(Instructions, LDA_AbsoluteY_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.a, "The A register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The A register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The A register should have been populated from the address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -831,7 +2076,7 @@ UTEST_F(Instructions, LDA_AbsoluteY_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.a, "The A register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The A register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The A register should have been populated from the address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -851,7 +2096,7 @@ UTEST_F(Instructions, LDA_AbsoluteY_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.a, "The A register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The A register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The A register should have been populated from the address 0x082C.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -905,7 +2150,7 @@ UTEST_F(Instructions, LDX_ZeroPage_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.x, "The X register's value should be 0x00.");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The X register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The X register should have been populated from the zero page address 0x00FF.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -920,7 +2165,7 @@ UTEST_F(Instructions, LDX_ZeroPage_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.x, "The X register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The X register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The X register should have been populated from the zero page address 0x00FF.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -935,7 +2180,7 @@ UTEST_F(Instructions, LDX_ZeroPage_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.x, "The X register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The X register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The X register should have been populated from the zero page address 0x00FF.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -954,7 +2199,7 @@ UTEST_F(Instructions, LDX_ZeroPageY_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.x, "The X register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The X register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The X register should have been populated from address 0x008F.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -973,7 +2218,7 @@ UTEST_F(Instructions, LDX_ZeroPageY_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.x, "The X register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The X register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The X register should have been populated from address 0x008F.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -991,7 +2236,7 @@ UTEST_F(Instructions, LDX_ZeroPageY_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.x, "The X register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The X register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The X register should have been populated from address 0x008F.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1010,7 +2255,7 @@ UTEST_F(Instructions, LDX_ZeroPageY_WrappingCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.x, "The X register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x007F, utest_fixture->ram.most_recent_read, "With wrapping, the X register should have been populated from address 0x007F.");
+    EXPECT_EQ_MSG(0x007F, utest_fixture->trace.most_recent(BusTrace::READ), "With wrapping, the X register should have been populated from address 0x007F.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1026,7 +2271,7 @@ UTEST_F(Instructions, LDX_Absolute_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.x, "The X register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The X register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The X register should have been populated from the address 0xAABB.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -1042,7 +2287,7 @@ UTEST_F(Instructions, LDX_Absolute_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.x, "The X register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The X register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The X register should have been populated from the address 0xAABB.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1058,7 +2303,7 @@ UTEST_F(Instructions, LDX_Absolute_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.x, "The X register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The X register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The X register should have been populated from the address 0xAABB.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1078,7 +2323,7 @@ UTEST_F(Instructions, LDX_AbsoluteY_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.x, "The X register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The X register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The X register should have been populated from the address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -1098,7 +2343,7 @@ UTEST_F(Instructions, LDX_AbsoluteY_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.x, "The X register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The X register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The X register should have been populated from the address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1118,7 +2363,7 @@ UTEST_F(Instructions, LDX_AbsoluteY_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.x, "The X register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The X register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The X register should have been populated from the address 0x082C.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1172,7 +2417,7 @@ UTEST_F(Instructions, LDY_ZeroPage_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.y, "The Y register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The Y register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The Y register should have been populated from the zero page address 0x00FF.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -1187,7 +2432,7 @@ UTEST_F(Instructions, LDY_ZeroPage_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.y, "The Y register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The Y register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The Y register should have been populated from the zero page address 0x00FF.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1202,7 +2447,7 @@ UTEST_F(Instructions, LDY_ZeroPage_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.y, "The Y register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x00FF, utest_fixture->ram.most_recent_read, "The Y register should have been populated from the zero page address 0x00FF.");
+    EXPECT_EQ_MSG(0x00FF, utest_fixture->trace.most_recent(BusTrace::READ), "The Y register should have been populated from the zero page address 0x00FF.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1221,7 +2466,7 @@ UTEST_F(Instructions, LDY_ZeroPageX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.y, "The Y register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The Y register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The Y register should have been populated from address 0x008F.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -1240,7 +2485,7 @@ UTEST_F(Instructions, LDY_ZeroPageX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.y, "The Y register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The Y register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The Y register should have been populated from address 0x008F.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1258,7 +2503,7 @@ UTEST_F(Instructions, LDY_ZeroPageX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.y, "The Y register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "The Y register should have been populated from address 0x008F.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "The Y register should have been populated from address 0x008F.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1277,7 +2522,7 @@ UTEST_F(Instructions, LDY_ZeroPageX_WrappingCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.y, "The Y register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x007F, utest_fixture->ram.most_recent_read, "With wrapping, the Y register should have been populated from address 0x007F.");
+    EXPECT_EQ_MSG(0x007F, utest_fixture->trace.most_recent(BusTrace::READ), "With wrapping, the Y register should have been populated from address 0x007F.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1293,7 +2538,7 @@ UTEST_F(Instructions, LDY_Absolute_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.y, "The Y register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The Y register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The Y register should have been populated from the address 0xAABB.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -1309,7 +2554,7 @@ UTEST_F(Instructions, LDY_Absolute_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.y, "The Y register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The Y register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The Y register should have been populated from the address 0xAABB.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1325,7 +2570,7 @@ UTEST_F(Instructions, LDY_Absolute_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.y, "The Y register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0xAABB, "The Y register should have been populated from the address 0xAABB.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0xAABB, "The Y register should have been populated from the address 0xAABB.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1345,7 +2590,7 @@ UTEST_F(Instructions, LDY_AbsoluteX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x00, utest_fixture->cpu.y, "The Y register's value should be 0x00 (0).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The Y register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The Y register should have been populated from the address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -1365,7 +2610,7 @@ UTEST_F(Instructions, LDY_AbsoluteX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x40, utest_fixture->cpu.y, "The Y register's value should be 0x40 (64).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The Y register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The Y register should have been populated from the address 0x082C.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1385,7 +2630,7 @@ UTEST_F(Instructions, LDY_AbsoluteX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(0x80, utest_fixture->cpu.y, "The Y register's value should be 0x80 (128).");
-    EXPECT_EQ_MSG(utest_fixture->ram.most_recent_read, 0x082C, "The Y register should have been populated from the address 0x082C.");
+    EXPECT_EQ_MSG(utest_fixture->trace.most_recent(BusTrace::READ), 0x082C, "The Y register should have been populated from the address 0x082C.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1918,7 +3163,7 @@ UTEST_F(Instructions, DEC_ZeroPageX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x008F), 0x00, "The value at memory address 0x008F should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "Memory address 0x008F should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0x008F should have been the most recently accessed memory index.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -1937,7 +3182,7 @@ UTEST_F(Instructions, DEC_ZeroPageX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x008F), 0x40, "The value at memory address 0x008F should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "Memory address 0x008F should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0x008F should have been the most recently accessed memory index.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1956,7 +3201,7 @@ UTEST_F(Instructions, DEC_ZeroPageX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x008F), 0xFF, "The value at memory address 0x008F should be 0xFF (255).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "Memory address 0x008F should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0x008F should have been the most recently accessed memory index.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -1972,7 +3217,7 @@ UTEST_F(Instructions, DEC_Absolute_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0xAABB), 0x00, "The value at memory address 0xAABB should be 0x00 (0).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "Memory address 0xAABB should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0xAABB should have been the most recently accessed memory index.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -1988,7 +3233,7 @@ UTEST_F(Instructions, DEC_Absolute_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0xAABB), 0x40, "The value at memory address 0xAABB should be 0x40 (64).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "Memory address 0xAABB should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0xAABB should have been the most recently accessed memory index.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2004,7 +3249,7 @@ UTEST_F(Instructions, DEC_Absolute_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0xAABB), 0xFF, "The value at memory address 0xAABB should be 0xFF (255).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "Memory address 0xAABB should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0xAABB should have been the most recently accessed memory index.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2024,7 +3269,7 @@ UTEST_F(Instructions, DEC_AbsoluteX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x082C), 0x00, "The value at memory address 0x082C should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_write, "The value at memory address 0x082C should have been decremented.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::WRITE), "The value at memory address 0x082C should have been decremented.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -2044,7 +3289,7 @@ UTEST_F(Instructions, DEC_AbsoluteX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x082C), 0x40, "The value at memory address 0x082C should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_write, "The value at memory address 0x082C should have been decremented.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::WRITE), "The value at memory address 0x082C should have been decremented.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2064,7 +3309,7 @@ UTEST_F(Instructions, DEC_AbsoluteX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x082C), 0xFF, "The value at memory address 0x082C should be 0xFF (255).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_write, "The value at memory address 0x082C should have been decremented.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::WRITE), "The value at memory address 0x082C should have been decremented.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2221,7 +3466,7 @@ UTEST_F(Instructions, INC_ZeroPageX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x008F), 0x00, "The value at memory address 0x008F should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "Memory address 0x008F should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0x008F should have been the most recently accessed memory index.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -2240,7 +3485,7 @@ UTEST_F(Instructions, INC_ZeroPageX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x008F), 0x01, "The value at memory address 0x008F should be 0x01 (1).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "Memory address 0x008F should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0x008F should have been the most recently accessed memory index.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2259,7 +3504,7 @@ UTEST_F(Instructions, INC_ZeroPageX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x008F), 0x81, "The value at memory address 0x008F should be 0x81 (129).");
-    EXPECT_EQ_MSG(0x008F, utest_fixture->ram.most_recent_read, "Memory address 0x008F should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0x008F, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0x008F should have been the most recently accessed memory index.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2275,7 +3520,7 @@ UTEST_F(Instructions, INC_Absolute_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0xAABB), 0x00, "The value at memory address 0xAABB should be 0x00 (0).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "Memory address 0xAABB should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0xAABB should have been the most recently accessed memory index.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -2291,7 +3536,7 @@ UTEST_F(Instructions, INC_Absolute_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0xAABB), 0x40, "The value at memory address 0xAABB should be 0x40 (64).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "Memory address 0xAABB should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0xAABB should have been the most recently accessed memory index.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2307,7 +3552,7 @@ UTEST_F(Instructions, INC_Absolute_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0xAABB), 0x80, "The value at memory address 0xAABB should be 0x80 (128).");
-    EXPECT_EQ_MSG(0xAABB, utest_fixture->ram.most_recent_read, "Memory address 0xAABB should have been the most recently accessed memory index.");
+    EXPECT_EQ_MSG(0xAABB, utest_fixture->trace.most_recent(BusTrace::READ), "Memory address 0xAABB should have been the most recently accessed memory index.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2327,7 +3572,7 @@ UTEST_F(Instructions, INC_AbsoluteX_ZeroCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x082C), 0x00, "The value at memory address 0x082C should be 0x00 (0).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_write, "The value at memory address 0x082C should have been incremented.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::WRITE), "The value at memory address 0x082C should have been incremented.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should be set.");
 }
@@ -2347,7 +3592,7 @@ UTEST_F(Instructions, INC_AbsoluteX_PositiveCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x082C), 0x40, "The value at memory address 0x082C should be 0x40 (64).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_write, "The value at memory address 0x082C should have been incremented.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::WRITE), "The value at memory address 0x082C should have been incremented.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should not be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -2367,7 +3612,7 @@ UTEST_F(Instructions, INC_AbsoluteX_NegativeCase) {
     utest_fixture->cpu.execute_instructions(utest_fixture->ram, instruction_count);
 
     EXPECT_EQ_MSG(utest_fixture->ram.read(0x082C), 0x80, "The value at memory address 0x082C should be 0x80 (128).");
-    EXPECT_EQ_MSG(0x082C, utest_fixture->ram.most_recent_write, "The value at memory address 0x082C should have been incremented.");
+    EXPECT_EQ_MSG(0x082C, utest_fixture->trace.most_recent(BusTrace::WRITE), "The value at memory address 0x082C should have been incremented.");
     EXPECT_TRUE_MSG(utest_fixture->cpu.has_status(CPU::NEGATIVE_FLAG), "The negative status flag should be set.");
     EXPECT_FALSE_MSG(utest_fixture->cpu.has_status(CPU::ZERO_FLAG), "The zero status flag should not be set.");
 }
@@ -0,0 +1,22 @@
+#!/bin/sh
+# Builds the command line tools on Linux. Pass -d for a debug build.
+
+exeNames="trace_diff stats disassemble"
+compilerFlags="-std=c++20 -Wall -Wextra -Werror -Wno-unused-parameter -Wno-unused-variable -Wno-ignored-qualifiers -fno-rtti"
+
+if [ "$1" = "-d" ]; then
+    compilerFlags="$compilerFlags -O0 -g"
+else
+    compilerFlags="$compilerFlags -O2"
+fi
+
+for exeName in $exeNames; do
+    rm -f "$exeName"
+
+    if ! ${CXX:-g++} $compilerFlags "src/$exeName.cpp" -o "$exeName"; then
+        echo "Build failed"
+        exit 1
+    fi
+done
+
+echo "Build successful"
\ No newline at end of file
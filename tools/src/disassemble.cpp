@@ -0,0 +1,79 @@
+#include "../../src/disassembler.h"
+#include "../../src/nes.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Usage: disassemble [-s symbols]... rom.nes
+// Lists every PRG ROM bank of an iNES image on stdout, with labels from ld65 .dbg or label files. Every bank is listed at $8000 except
+// the last, which is listed at $C000: where NROM maps it, and where most other mappers keep their fixed bank.
+int main(int argc, char** argv) {
+    SymbolTable symbols;
+
+    int argument = 1;
+    while(argc - argument > 2 && strcmp(argv[argument], "-s") == 0) {
+        if(!symbols.load(argv[argument + 1])) {
+            fprintf(stderr, "Could not read symbols from %s\n", argv[argument + 1]);
+            return 1;
+        }
+        argument += 2;
+    }
+
+    if(argc - argument != 1) {
+        fprintf(stderr, "Usage: %s [-s symbols]... rom.nes\n", argv[0]);
+        return 2;
+    }
+
+    FILE* file = fopen(argv[argument], "rb");
+    if(!file) {
+        fprintf(stderr, "Could not open %s\n", argv[argument]);
+        return 1;
+    }
+    fseek(file, 0, SEEK_END);
+    const long size = ftell(file);
+    fseek(file, 0, SEEK_SET);
+
+    u8* rom           = new u8[size > 0 ? static_cast<size_t>(size) : 1];
+    const size_t read = size > 0 ? fread(rom, 1, static_cast<size_t>(size), file) : 0;
+    fclose(file);
+
+    u32 magic = 0;
+    if(read >= NES::INES_HEADER) {
+        memcpy(&magic, rom, sizeof(magic));
+    }
+    const size_t banks     = read >= NES::INES_HEADER ? rom[4] : 0;
+    const size_t prg_start = NES::INES_HEADER + ((read >= NES::INES_HEADER && (rom[6] & 0x04)) ? NES::INES_TRAINER : 0);
+    if(magic != NES::INES_MAGIC || !banks || read < prg_start + banks * NES::PRG_BANK_SIZE) {
+        fprintf(stderr, "%s is not an iNES image\n", argv[argument]);
+        delete[] rom;
+        return 1;
+    }
+
+    Disassembler disassembler;
+    disassembler.symbols = symbols.count ? &symbols : nullptr;
+
+    static constexpr size_t OUTPUT_SIZE = MB(1);
+    char* output = new char[OUTPUT_SIZE];
+
+    const auto start = std::chrono::steady_clock::now();
+    for(size_t bank = 0; bank < banks; bank++) {
+        const u16 base = bank == banks - 1 ? 0xC000 : 0x8000;
+        const u8* data = &rom[prg_start + bank * NES::PRG_BANK_SIZE];
+
+        printf("; Bank %zu at $%4.4X\n", bank, base);
+        for(size_t offset = 0; offset < NES::PRG_BANK_SIZE;) {
+            size_t consumed;
+            const size_t length = disassembler.disassemble(&data[offset], NES::PRG_BANK_SIZE - offset, static_cast<u16>(base + offset), output,
+                                                           OUTPUT_SIZE, consumed);
+            fwrite(output, 1, length, stdout);
+            offset += consumed;
+        }
+    }
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    fprintf(stderr, "%zu KB of PRG ROM in %.1f ms\n", banks * NES::PRG_BANK_SIZE / KB(1), seconds * 1e3);
+
+    delete[] output;
+    delete[] rom;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,68 @@
+#include "../../src/stats_page.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <thread>
+
+// Usage: stats [-i milliseconds] [-n count] [-v] name
+// Prints the counters a running emulator publishes to the named stats page every interval, count times or until interrupted.
+// With -v every instance's row is printed as well.
+int main(int argc, char** argv) {
+    u64 interval = 1000;
+    u64 count    = 0;
+    bool verbose = false;
+    int argument = 1;
+    for(; argument < argc - 1; argument++) {
+        if(strcmp(argv[argument], "-i") == 0 && argument + 2 < argc) {
+            interval = strtoull(argv[++argument], nullptr, 10);
+        } else if(strcmp(argv[argument], "-n") == 0 && argument + 2 < argc) {
+            count = strtoull(argv[++argument], nullptr, 10);
+        } else if(strcmp(argv[argument], "-v") == 0) {
+            verbose = true;
+        } else {
+            break;
+        }
+    }
+
+    if(argc - argument != 1) {
+        printf("Usage: %s [-i milliseconds] [-n count] [-v] name\n", argv[0]);
+        return 2;
+    }
+
+    StatsPage page;
+    if(!page.open(argv[argument])) {
+        printf("No stats page named %s\n", argv[argument]);
+        return 1;
+    }
+
+    const u32 capacity        = page.header->instance_capacity;
+    StatsPage::Instance* rows = new StatsPage::Instance[capacity ? capacity : 1];
+    StatsPage::Totals totals;
+
+    printf("%10s %10s %12s %10s %10s %9s %16s\n", "update", "elapsed", "frames/s", "MIPS", "speed", "instances", "cycles");
+    for(u64 printed = 0; !count || printed < count; printed++) {
+        if(printed) {
+            std::this_thread::sleep_for(std::chrono::milliseconds(interval));
+        }
+
+        if(!page.read(totals, rows, capacity)) {
+            printf("The publisher did not finish an update\n");
+            continue;
+        }
+
+        printf("%10llu %9.1fs %12.1f %10.2f %9.2fx %9u %16llu\n", (unsigned long long)totals.updates, static_cast<double>(totals.elapsed_ns) / 1e9,
+               totals.frames_per_second, totals.mips, totals.speed, totals.instance_count, (unsigned long long)totals.cycles);
+
+        if(verbose) {
+            for(u32 i = 0; i < totals.instance_count && i < capacity; i++) {
+                printf("  %6u %16llu cycles %16llu instructions %10llu frames\n", i, (unsigned long long)rows[i].cycles,
+                       (unsigned long long)rows[i].instructions, (unsigned long long)rows[i].frames);
+            }
+        }
+        fflush(stdout);
+    }
+
+    delete[] rows;
+    return 0;
+}
\ No newline at end of file
@@ -0,0 +1,36 @@
+#include "../../src/trace_diff.h"
+#include <chrono>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Usage: trace_diff [-c columns] expected.log actual.log
+// Exits with 0 when the logs match and 1 at the first divergence, printing the line number and both lines.
+int main(int argc, char** argv) {
+    TraceDiff diff;
+
+    int argument = 1;
+    if(argc > 2 && strcmp(argv[1], "-c") == 0) {
+        diff.columns = strtoul(argv[2], nullptr, 10);
+        argument += 2;
+    }
+
+    if(argc - argument != 2) {
+        printf("Usage: %s [-c columns] expected.log actual.log\n", argv[0]);
+        return 2;
+    }
+
+    const auto start     = std::chrono::steady_clock::now();
+    const bool matched   = diff.compare(argv[argument], argv[argument + 1]);
+    const double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    if(matched) {
+        printf("Logs match: %llu lines in %.2fs\n", (unsigned long long)diff.lines, seconds);
+        return 0;
+    }
+
+    printf("First divergence at line %llu\n", (unsigned long long)diff.line);
+    printf("  expected: %s\n", diff.expected_line);
+    printf("  actual:   %s\n", diff.actual_line);
+    return 1;
+}
\ No newline at end of file